@@ -0,0 +1,103 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include "../ChainTable/ConcurrentChainTable.h"
+
+using std::cout;
+using std::endl;
+using namespace std::chrono;
+using namespace DS;
+
+// Measures the throughput of the concurrent hash table on read heavy and mixed workloads,
+// with 1, 2, 4, ... threads, against the same table with a single shard (one writer lock for all the keys).
+// Usage: concurrent_bench [keys] [operations per thread] [max threads]
+
+// Runs threads threads, each doing ops operations on random keys of [1, 2*keys]: reads_percent of them
+// are lookups, and the rest are split between inserts and erases, so the table keeps about keys elements.
+// Returns the throughput in Mops/s.
+template<class TABLE>
+double measure(TABLE& table, int keys, int ops, int threads, int reads_percent)
+{
+    std::vector<std::thread> workers;
+    std::vector<long long> found(threads, 0);
+    auto start = high_resolution_clock::now();
+    for(int t = 0; t < threads; t++)
+    {
+        workers.push_back(std::thread([&table, &found, keys, ops, reads_percent, t]()
+        {
+            std::mt19937 generator(2022 + t);
+            long long sum = 0;
+            for(int i = 0; i < ops; i++)
+            {
+                int key = 1 + generator() % (2 * keys);
+                int dice = generator() % 100;
+                if(dice < reads_percent)
+                {
+                    table.read(key, [&sum](const int& value) { sum += value; });
+                }
+                else if(dice % 2)
+                {
+                    table.insert(key, key);
+                }
+                else
+                {
+                    table.erase(key);
+                }
+            }
+            found[t] = sum;
+        }));
+    }
+    for(std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    auto end = high_resolution_clock::now();
+    return (double)ops * threads / duration_cast<nanoseconds>(end - start).count() * 1000;
+}
+
+// Fills a table with every other key of [1, 2*keys] and measures every thread count on it.
+template<class TABLE>
+void measureMix(const char* name, int keys, int ops, int max_threads, int reads_percent)
+{
+    TABLE* table = new TABLE();
+    for(int key = 2; key <= 2 * keys; key += 2)
+    {
+        table->insert(key, key);
+    }
+    double single = 0;
+    cout << name << ", " << reads_percent << "% reads:";
+    for(int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        double throughput = measure(*table, keys, ops, threads, reads_percent);
+        if(threads == 1)
+        {
+            single = throughput;
+        }
+        cout << "  " << threads << "T " << throughput << " Mops/s (x" << throughput / single << ")";
+    }
+    cout << endl;
+    delete table;
+}
+
+int main(int argc, char** argv)
+{
+    int num_keys = argc > 1? (int)atof(argv[1]) : 1000000;
+    int num_ops = argc > 2? (int)atof(argv[2]) : 2000000;
+    int max_threads = argc > 3? atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+    if(max_threads < 1)
+    {
+        max_threads = 1;
+    }
+
+    cout << num_keys << " keys, " << num_ops << " operations per thread, up to " << max_threads << " threads" << endl;
+    const int mixes[] = { 100, 95, 50 };
+    for(int reads_percent : mixes)
+    {
+        measureMix<ConcurrentChainTable<int>>("64 shards", num_keys, num_ops, max_threads, reads_percent);
+        measureMix<ConcurrentChainTable<int, FibonacciHash<int>, 1>>("1 shard", num_keys, num_ops, max_threads, reads_percent);
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include "../DynamicArray/DynamicArray.h"
+
+using std::cout;
+using std::endl;
+using namespace std::chrono;
+using namespace DS;
+
+// Compares the latency of appending to a DynamicArray that grows all at once, and to one that grows incrementally.
+// Usage: growth_bench [stores]
+
+// The size of a class entry of Boom2.
+struct Entry
+{
+    long long views;
+    long long course;
+    long long lecture;
+    long long handle;
+};
+
+// Stores count entries one after the other, starting from 10 cells, and prints the percentiles of the store times.
+template<bool INCREMENTAL_GROWTH>
+void measure(const char* name, int count)
+{
+    std::vector<long long> times(count);
+    DynamicArray<Entry, INCREMENTAL_GROWTH>* array = new DynamicArray<Entry, INCREMENTAL_GROWTH>(10, Entry(), 2);
+    auto start = high_resolution_clock::now();
+    for(int i = 0; i < count; i++)
+    {
+        auto before = high_resolution_clock::now();
+        array->store(i, Entry{i, i, i, i});
+        times[i] = duration_cast<nanoseconds>(high_resolution_clock::now() - before).count();
+    }
+    auto end = high_resolution_clock::now();
+    delete array;
+
+    std::sort(times.begin(), times.end());
+    cout << name << ": total " << duration_cast<microseconds>(end - start).count() / 1000.0 << " ms, store p50 "
+         << times[count / 2] << " ns, p99 " << times[(long long)count * 99 / 100] << " ns, p99.99 "
+         << times[(long long)count * 9999 / 10000] << " ns, max " << times[count - 1] / 1000.0 << " us" << endl;
+}
+
+int main(int argc, char** argv)
+{
+    int count = argc > 1? (int)atof(argv[1]) : 10000000;
+    cout << count << " stores of " << sizeof(Entry) << " bytes" << endl;
+    measure<false>("Whole growth", count);
+    measure<true>("Incremental growth", count);
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include "../LectureRanking.h"
+
+using std::cout;
+using std::endl;
+using namespace std::chrono;
+using namespace DS;
+
+// Compares the lecture rankings of Boom2 on large numbers of watched classes.
+// Usage: rank_bench [lectures] [queries]
+// (1e8 lectures take a few GBs of memory in each ranking)
+
+// Adds all the lectures, then moves a part of them to new views, and runs select and rank queries.
+template<class RANKING>
+void measure(const char* name, std::vector<LectureContainer>& lectures, int queries)
+{
+    std::mt19937 generator(7);
+    RANKING* ranking = new RANKING();
+    std::vector<typename RANKING::handle> handles(lectures.size());
+
+    auto start = high_resolution_clock::now();
+    for(size_t i = 0; i < lectures.size(); i++)
+    {
+        handles[i] = ranking->insert(lectures[i]);
+    }
+    auto inserted = high_resolution_clock::now();
+    for(int k = 0; k < queries; k++)
+    {
+        size_t i = generator() % lectures.size();
+        LectureContainer old_lecture = lectures[i];
+        lectures[i].addViews(1 + generator() % 100);
+        ranking->update(handles[i], old_lecture, lectures[i]);
+    }
+    auto updated = high_resolution_clock::now();
+    long long checksum = 0;
+    for(int k = 0; k < queries; k++)
+    {
+        checksum += ranking->ith(1 + generator() % ranking->size()).lecture();
+    }
+    auto selected = high_resolution_clock::now();
+    for(int k = 0; k < queries; k++)
+    {
+        checksum += ranking->rankOf(lectures[generator() % lectures.size()]);
+    }
+    auto ranked = high_resolution_clock::now();
+
+    double n = (double)lectures.size();
+    cout << name << ": insert " << n / duration_cast<nanoseconds>(inserted - start).count() * 1000
+         << " Mops/s, update " << (double)queries / duration_cast<nanoseconds>(updated - inserted).count() * 1000
+         << " Mops/s, select " << (double)queries / duration_cast<nanoseconds>(selected - updated).count() * 1000
+         << " Mops/s, rank " << (double)queries / duration_cast<nanoseconds>(ranked - selected).count() * 1000
+         << " Mops/s (checksum " << checksum << ")" << endl;
+    delete ranking;
+}
+
+int main(int argc, char** argv)
+{
+    int num_lectures = argc > 1? (int)atof(argv[1]) : 1000000;
+    int queries = argc > 2? (int)atof(argv[2]) : 1000000;
+
+    // Lectures of 1000 classes per course, with views of a skewed spread:
+    std::mt19937 generator(2022);
+    std::vector<LectureContainer> lectures(num_lectures);
+    for(int i = 0; i < num_lectures; i++)
+    {
+        int spread = 1 << (generator() % 20);
+        lectures[i] = LectureContainer(1 + (int)(generator() % spread), 1 + i / 1000, i % 1000);
+    }
+    std::vector<LectureContainer> copy(lectures);
+
+    cout << num_lectures << " lectures, " << queries << " queries" << endl;
+    measure<AVLRanking>("RankAVL", lectures, queries);
+    measure<BTreeRanking>("RankBTree", copy, queries);
+    return 0;
+}
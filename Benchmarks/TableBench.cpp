@@ -0,0 +1,107 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include "../ChainTable/ChainTable.h"
+#include "../FlatTable/FlatTable.h"
+
+using std::cout;
+using std::endl;
+using namespace std::chrono;
+using namespace DS;
+
+// Compares the hash tables on course ids.
+// Usage: table_bench [keys] [lookups]
+
+// Inserts all the keys, looks up random keys (half of them missing), and erases all the keys.
+template<class TABLE>
+void measure(const char* name, const std::vector<int>& keys, const std::vector<int>& lookups)
+{
+    TABLE* table = new TABLE();
+    auto start = high_resolution_clock::now();
+    for(int key : keys)
+    {
+        table->insert(key, key);
+    }
+    auto inserted = high_resolution_clock::now();
+    long long found = 0;
+    for(int key : lookups)
+    {
+        if(table->find(key))
+        {
+            found += table->get(key);
+        }
+    }
+    auto looked_up = high_resolution_clock::now();
+    for(int key : keys)
+    {
+        table->erase(key);
+    }
+    auto erased = high_resolution_clock::now();
+
+    double n = (double)keys.size();
+    cout << name << ": insert " << n / duration_cast<nanoseconds>(inserted - start).count() * 1000
+         << " Mops/s, lookup " << (double)lookups.size() / duration_cast<nanoseconds>(looked_up - inserted).count() * 1000
+         << " Mops/s, erase " << n / duration_cast<nanoseconds>(erased - looked_up).count() * 1000
+         << " Mops/s (found " << found << ")" << endl;
+    delete table;
+}
+
+// Looks up the same keys as measure, BATCH at a time with getBatch.
+template<class TABLE>
+void measureBatch(const char* name, const std::vector<int>& keys, const std::vector<int>& lookups)
+{
+    const int BATCH = 256;
+    TABLE* table = new TABLE();
+    for(int key : keys)
+    {
+        table->insert(key, key);
+    }
+    const int* values[BATCH];
+    long long found = 0;
+    auto start = high_resolution_clock::now();
+    for(size_t first = 0; first < lookups.size(); first += BATCH)
+    {
+        int count = lookups.size() - first < (size_t)BATCH? lookups.size() - first : BATCH;
+        table->getBatch(&lookups[first], count, values);
+        for(int i = 0; i < count; i++)
+        {
+            if(values[i])
+            {
+                found += *values[i];
+            }
+        }
+    }
+    auto looked_up = high_resolution_clock::now();
+
+    cout << name << ": lookup " << (double)lookups.size() / duration_cast<nanoseconds>(looked_up - start).count() * 1000
+         << " Mops/s in batches of " << BATCH << " (found " << found << ")" << endl;
+    delete table;
+}
+
+int main(int argc, char** argv)
+{
+    int num_keys = argc > 1? (int)atof(argv[1]) : 1000000;
+    int num_lookups = argc > 2? (int)atof(argv[2]) : 10000000;
+
+    std::mt19937 generator(2022);
+    std::vector<int> keys(num_keys);
+    for(int i = 0; i < num_keys; i++)
+    {
+        keys[i] = i + 1;
+    }
+    std::shuffle(keys.begin(), keys.end(), generator);
+    std::vector<int> lookups(num_lookups);
+    for(int i = 0; i < num_lookups; i++)
+    {
+        lookups[i] = 1 + generator() % (2 * num_keys);
+    }
+
+    cout << num_keys << " keys, " << num_lookups << " lookups" << endl;
+    measure<ChainTable<int>>("ChainTable", keys, lookups);
+    measureBatch<ChainTable<int>>("ChainTable", keys, lookups);
+    measure<FlatTable<int>>("FlatTable", keys, lookups);
+    return 0;
+}
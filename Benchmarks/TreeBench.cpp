@@ -0,0 +1,98 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include "../RankAVL/RankAVL.h"
+
+using std::cout;
+using std::endl;
+using namespace std::chrono;
+using namespace DS;
+
+// Microbenchmark of the insert and erase throughput of the trees.
+// Usage: tree_bench [keys] [repetitions]
+
+// Keeps the size of the sub tree of each node in its val.
+class SubtreeSize
+{
+public:
+    template<class NODE>
+    void operator()(NODE& node, const NODE* left, const NODE* right)
+    {
+        int left_size = left? left->val : 0;
+        int right_size = right? right->val : 0;
+        node.val = left_size + right_size + 1;
+    }
+};
+
+template<class TREE>
+struct Plain
+{
+    static TREE* create()
+    {
+        return new TREE();
+    }
+};
+
+template<class TREE>
+struct Ranked
+{
+    static TREE* create()
+    {
+        return new TREE(SubtreeSize());
+    }
+};
+
+// Inserts all the keys, then erases them in a different order, and prints the throughput of both.
+template<class TREE, template<class> class FACTORY>
+void measure(const char* name, const std::vector<int>& keys, const std::vector<int>& erase_order, int repetitions)
+{
+    long long insert_ns = 0;
+    long long erase_ns = 0;
+    for(int i = 0; i < repetitions; i++)
+    {
+        TREE* tree = FACTORY<TREE>::create();
+        auto start = high_resolution_clock::now();
+        for(int key : keys)
+        {
+            tree->insert(key, 0);
+        }
+        auto middle = high_resolution_clock::now();
+        for(int key : erase_order)
+        {
+            tree->erase(key);
+        }
+        auto stop = high_resolution_clock::now();
+        insert_ns += duration_cast<nanoseconds>(middle - start).count();
+        erase_ns += duration_cast<nanoseconds>(stop - middle).count();
+        delete tree;
+    }
+    double ops = (double)keys.size() * repetitions;
+    cout << name << ": insert " << ops / insert_ns * 1000 << " Mops/s, erase "
+         << ops / erase_ns * 1000 << " Mops/s" << endl;
+}
+
+int main(int argc, char** argv)
+{
+    int num_keys = argc > 1? atoi(argv[1]) : 1000000;
+    int repetitions = argc > 2? atoi(argv[2]) : 3;
+
+    std::mt19937 generator(2022);
+    std::vector<int> keys(num_keys);
+    for(int i = 0; i < num_keys; i++)
+    {
+        keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), generator);
+    std::vector<int> erase_order(keys);
+    std::shuffle(erase_order.begin(), erase_order.end(), generator);
+
+    cout << num_keys << " random keys, " << repetitions << " repetitions" << endl;
+    measure<AVL<int, int>, Plain>("AVL (shared nodes)", keys, erase_order, repetitions);
+    measure<AVL<int, int, NodePool<int, int>>, Plain>("AVL (node pool)", keys, erase_order, repetitions);
+    measure<RankAVL<SubtreeSize, int, int>, Ranked>("RankAVL (shared nodes)", keys, erase_order, repetitions);
+    measure<RankAVL<SubtreeSize, int, int, NodePool<int, int>>, Ranked>("RankAVL (node pool)", keys, erase_order, repetitions);
+    return 0;
+}
@@ -1,164 +1,239 @@
 #include "Boom2.h"
+#include <climits>
+#include <new>
 
 namespace DS
 {
-    Boom2::Boom2() : 
-    lecture_tree(RankAVL<SubtreeSize, LectureContainer, int>(SubtreeSize())), lecture_counter(0) { }
+    template<class RANKING, template<typename> class COURSE_TABLE>
+    BasicBoom2<RANKING, COURSE_TABLE>::BasicBoom2() : 
+    lecture_counter(0) { }
     
-    // Returns false if the course already exist, true if the insertion succeeded.
-    bool Boom2::addCourse(int course_id)
+    // Makes room for the given number of courses, each with classes_per_course classes, so that adding
+    // and watching them does not resize the course table, the class arrays or the ranking.
+    // Throws std::bad_alloc, before changing anything, if there are more classes than an int can count
+    // or more courses than the course table can hold.
+    template<class RANKING, template<typename> class COURSE_TABLE>
+    void BasicBoom2<RANKING, COURSE_TABLE>::reserve(int courses, int classes_per_course)
     {
-        if (course_id <= 0)
+        if(courses < 0 || classes_per_course < 0)
         {
             throw InvalidInput();
         }
-        if (course_table.find(course_id))
+        long long classes = static_cast<long long>(courses) * classes_per_course;
+        if(classes > INT_MAX)
         {
-            return false;
+            throw std::bad_alloc();
         }
-        
-        course_table.insert(course_id, lectures());
-        return true;
+        course_table.reserve(courses);
+        ranking.reserve(classes - ranking.size());
+        expected_classes = classes_per_course;
     }
 
-    // Returns false if there is no course with the given id, true if the deletion succeeded.
-    bool Boom2::removeCourse(int course_id)
+    // Returns false if the course already exist, true if the insertion succeeded.
+    template<class RANKING, template<typename> class COURSE_TABLE>
+    bool BasicBoom2<RANKING, COURSE_TABLE>::addCourse(int course_id)
     {
-        if(course_id <= 0)
+        if (course_id <= 0)
         {
             throw InvalidInput();
         }
-        if(!course_table.find(course_id))
+        return course_table.emplace(course_id, expected_classes);
+    }
+
+    // Returns false if there is no course with the given id, true if the deletion succeeded.
+    template<class RANKING, template<typename> class COURSE_TABLE>
+    bool BasicBoom2<RANKING, COURSE_TABLE>::removeCourse(int course_id)
+    {
+        if(course_id <= 0)
         {
-            return false;
+            throw InvalidInput();
         }
-
-        auto& lecture_arr = course_table.get(course_id).array;
-        int num_of_lectures = course_table.get(course_id).top;
-        for(int i = 0; i < num_of_lectures; i++)
+        // The course is found once, and its watched classes leave the ranking just before it leaves the table.
+        return course_table.extract(course_id, [this](lectures& course)
         {
-            if(lecture_arr.get(i).views)
+            auto& lecture_arr = course.array;
+            int num_of_lectures = course.top;
+            for(int i = 0; i < num_of_lectures; i++)
             {
-                lecture_tree.erase(lecture_arr.get(i));
+                // A get may move cells of a growing array, so the entry is read with a single one.
+                const LectureEntry& entry = lecture_arr.get(i);
+                if(entry.lecture.views())
+                {
+                    ranking.erase(entry.node, entry.lecture);
+                }
             }
-        }
-        course_table.erase(course_id);
-        return true;
+        });
     }
 
     // Returns false if the course doesn't exist, true if the class was added successfully.
-    bool Boom2::addClass(int course_id, int* class_id)
+    template<class RANKING, template<typename> class COURSE_TABLE>
+    bool BasicBoom2<RANKING, COURSE_TABLE>::addClass(int course_id, int* class_id)
     {
         if(course_id <= 0)
         {
             throw InvalidInput();
         }
-        if(!course_table.find(course_id))
+        lectures* course = course_table.tryGet(course_id);
+        if(!course)
         {
             return false;
         }
 
-        lectures& lectures_arr = course_table.get(course_id);
+        lectures& lectures_arr = *course;
         int top = lectures_arr.top;
-        LectureContainer lecture = {0, course_id, top};
-        lectures_arr.array.store(top, lecture);
+        LectureEntry entry = {{0, course_id, top}, 0};
+        lectures_arr.array.store(top, entry);
         *class_id = top;
         lectures_arr.top++;
         return true;
     }
 
     // Returns false if the course doesn't exist, true if time was added successfully.
-    bool Boom2::watchClass(int course_id, int class_id, int time)
+    template<class RANKING, template<typename> class COURSE_TABLE>
+    bool BasicBoom2<RANKING, COURSE_TABLE>::watchClass(int course_id, int class_id, int time)
     {
         if(time <= 0 || class_id < 0 || course_id <= 0)
         {
             throw InvalidInput();
         }
-        if(!course_table.find(course_id))
+        lectures* course = course_table.tryGet(course_id);
+        if(!course)
         {
             return false;
         }
-        lectures& lecture_arr = course_table.get(course_id);
+        lectures& lecture_arr = *course;
         if(class_id + 1 > lecture_arr.array.initialized())
         {
             throw InvalidInput();
         }
 
-        auto old_lecture = lecture_arr.array.get(class_id);
-        LectureContainer new_lecture = {old_lecture.views + time, old_lecture.course, old_lecture.lecture};
-        lecture_arr.array.store(class_id, new_lecture);
-        lecture_tree.erase(old_lecture);
-        lecture_tree.insert(new_lecture, 0);
+        LectureEntry& entry = lecture_arr.array.get(class_id);
+        LectureContainer old_lecture = entry.lecture;
+        entry.lecture.addViews(time);
+        if(old_lecture.views())
+        {
+            ranking.update(entry.node, old_lecture, entry.lecture);
+        }
+        else
+        {
+            entry.node = ranking.insert(entry.lecture);
+        }
         return true;
     }
 
-    bool Boom2::timeViewed(int course_id, int class_id, int* time_viewed)
+    template<class RANKING, template<typename> class COURSE_TABLE>
+    bool BasicBoom2<RANKING, COURSE_TABLE>::timeViewed(int course_id, int class_id, int* time_viewed)
     {
         if(course_id <= 0 || class_id < 0)
         {
             throw InvalidInput();
         }
-        if(!course_table.find(course_id))
+        lectures* course = course_table.tryGet(course_id);
+        if(!course)
         {
             return false;
         }
-        lectures& lecture_arr = course_table.get(course_id);
+        lectures& lecture_arr = *course;
         if(class_id + 1 > lecture_arr.array.initialized())
         {
             throw InvalidInput();
         }
 
-        *time_viewed = lecture_arr.array.get(class_id).views;
+        *time_viewed = lecture_arr.array.get(class_id).lecture.views();
         return true;
     }
 
-    bool Boom2::getIthWatchedClass(int i, int* course_id, int* class_id)
+    template<class RANKING, template<typename> class COURSE_TABLE>
+    bool BasicBoom2<RANKING, COURSE_TABLE>::getIthWatchedClass(int i, int* course_id, int* class_id)
     {
         if(i <= 0)
         {
             throw InvalidInput();
         }
-        if(lecture_tree.size() < i)
+        if(ranking.size() < i)
         {
             return false;
         }
-        
-        class FindIthWatchedClass
+
+        const LectureContainer& target = ranking.ith(i);
+        *course_id = target.course();
+        *class_id = target.lecture();
+
+        return true;
+    }
+
+    // Returns false if there are less than 'to' watched classes, true if the classes were written successfully.
+    template<class RANKING, template<typename> class COURSE_TABLE>
+    bool BasicBoom2<RANKING, COURSE_TABLE>::getWatchedClassesRange(int from, int to, int* course_ids, int* class_ids)
+    {
+        if(from <= 0 || to < from || !course_ids || !class_ids)
+        {
+            throw InvalidInput();
+        }
+        if(ranking.size() < to)
         {
-            int i;
-        public:
-            FindIthWatchedClass(int i) : i(i) { }
+            return false;
+        }
 
-            SearchPath operator()(std::shared_ptr<graph_node<LectureContainer, int>>& node)
+        ranking.range(from, to, course_ids, class_ids);
+        return true;
+    }
+
+    // Returns false if there are less than ranks[count - 1] watched classes, true if the classes were written successfully.
+    // The ranks must be sorted in ascending order.
+    template<class RANKING, template<typename> class COURSE_TABLE>
+    bool BasicBoom2<RANKING, COURSE_TABLE>::getIthWatchedClasses(const int* ranks, int count, int* course_ids, int* class_ids)
+    {
+        if(count <= 0 || !ranks || !course_ids || !class_ids || ranks[0] <= 0)
+        {
+            throw InvalidInput();
+        }
+        for(int i = 1; i < count; i++)
+        {
+            if(ranks[i] < ranks[i - 1])
             {
-                SearchPath result = SearchPath::end;
-                int right_rank = node->right? node->right->val : 0;
-                if(right_rank == i - 1) // The current node is the wanted node.
-                {
-                    return result;
-                }
-                else if(right_rank > i - 1) // The node we are looking for is in the right sub-tree.
-                {
-                    node = node->right;
-                    result = SearchPath::right;
-                }
-                else // right_rank < i - 1: The node we are looking for is in the left sub-tree.
-                {
-                    node = node->left;
-                    result = SearchPath::left;
-                    i = i - right_rank - 1;
-                }
-                
-                return result;
+                throw InvalidInput();
             }
-        };
+        }
+        if(ranking.size() < ranks[count - 1])
+        {
+            return false;
+        }
 
-        FindIthWatchedClass calc_functor(i);
-        const std::shared_ptr<graph_node<LectureContainer, int>>& target = lecture_tree.rank(calc_functor);
-        *course_id = target->key.course;
-        *class_id = target->key.lecture;
+        ranking.batch(ranks, count, course_ids, class_ids);
+        return true;
+    }
+
+    // Returns false if the course doesn't exist or the class was never watched, true if the rank was found.
+    template<class RANKING, template<typename> class COURSE_TABLE>
+    bool BasicBoom2<RANKING, COURSE_TABLE>::getRankOfClass(int course_id, int class_id, int* rank)
+    {
+        if(course_id <= 0 || class_id < 0 || !rank)
+        {
+            throw InvalidInput();
+        }
+        lectures* course = course_table.tryGet(course_id);
+        if(!course)
+        {
+            return false;
+        }
+        lectures& lecture_arr = *course;
+        if(class_id + 1 > lecture_arr.array.initialized())
+        {
+            throw InvalidInput();
+        }
+        const LectureContainer& lecture = lecture_arr.array.get(class_id).lecture;
+        if(!lecture.views())
+        {
+            return false;
+        }
 
+        *rank = ranking.rankOf(lecture);
         return true;
     }
 
-}
\ No newline at end of file
+    template class BasicBoom2<AVLRanking, ChainCourseTable>;
+    template class BasicBoom2<BTreeRanking, ChainCourseTable>;
+    template class BasicBoom2<AVLRanking, FlatCourseTable>;
+    template class BasicBoom2<BTreeRanking, FlatCourseTable>;
+}
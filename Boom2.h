@@ -1,116 +1,85 @@
 #ifndef _BOOM_H
 #define _BOOM_H
-#include "RankAVL/AVL.h"
-#include "RankAVL/RankAVL.h"
+#include "LectureRanking.h"
 #include "DynamicArray/DynamicArray.h"
 #include "ChainTable/ChainTable.h"
+#include "FlatTable/FlatTable.h"
 
 
 namespace DS
 {
-    struct LectureContainer
-    {
-        int views;
-        int course;
-        int lecture;
-
-        bool operator<(const LectureContainer& other) const
-        {
-            if(views < other.views)
-            {
-                return true;
-            }
-            else if(views > other.views)
-            {
-                return false;
-            }
-            // If reached this point, views == other.views
-            if(course > other.course)
-            {
-                return true;
-            }
-            else if(course < other.course)
-            {
-                return false;
-            }
-            // If reached this point, views == other.views && course == other.course
-            if(lecture > other.lecture)
-            {
-                return true;
-            }
-            return false;
-        }
-
-        bool operator==(const LectureContainer& other) const
-        {
-            return (views == other.views) && (course == other.course) && (lecture == other.lecture);
-        }
-
-        bool operator!=(const LectureContainer& other) const
-        {
-            return !(*this == other);
-        }
-
-        bool operator<=(const LectureContainer& other) const
-        {
-            return (*this < other) || (*this == other);
-        }
-
-        bool operator>(const LectureContainer& other) const
-        {
-            return !(*this <= other);
-        }
-
-        bool operator>=(const LectureContainer& other) const
-        {
-            return (*this > other) || (*this == other);
-        }
-    };
-
-    class Boom2
+    // The course tables to pick from, as templates of the value alone:
+    template<typename VAL_TYPE>
+    using ChainCourseTable = ChainTable<VAL_TYPE>;
+
+    template<typename VAL_TYPE>
+    using FlatCourseTable = FlatTable<VAL_TYPE>;
+
+    /*
+     * Class: BasicBoom2
+     * ---------------------------------------
+     * The courses and classes of Boom2, where the ranking of the watched classes is kept by RANKING
+     * (see LectureRanking.h for the rankings to pick from), and the courses by a COURSE_TABLE,
+     * a hash table of int keys with the interface of ChainTable.
+     */
+    template<class RANKING, template<typename> class COURSE_TABLE>
+    class BasicBoom2
     {
     private:
+        // A class of a course, and its handle in the ranking (valid only once it was watched).
+        struct LectureEntry
+        {
+            LectureContainer lecture;
+            typename RANKING::handle node;
+        };
 
         class lectures
         {
         public:
-            DynamicArray<LectureContainer> array;
+            DynamicArray<LectureEntry, true> array; // Grows incrementally, so no single AddClass moves every class of the course
             int top = 0;
 
-            lectures() : array(DynamicArray<LectureContainer>(10, {0, 0, 0}, 2)), top(0) { }
-        };
-
-        class SubtreeSize
-        {
-        public:
-            void operator()(std::shared_ptr<graph_node<LectureContainer, int>>& node)
+            // Makes room for expected_classes classes up front. (see reserve)
+            explicit lectures(int expected_classes = 0) : array(DynamicArray<LectureEntry, true>(10, {{0, 0, 0}, 0}, 2)), top(0)
             {
-                if(!node)
-                {
-                    return;
-                }
-                int left_size = node->left? node->left->val : 0;
-                int right_size = node->right? node->right->val : 0;
-                node->val = left_size + right_size + 1;
+                array.reserve(expected_classes);
             }
         };
 
-        ChainTable<lectures> course_table;
-        RankAVL<SubtreeSize, LectureContainer, int> lecture_tree;
+        COURSE_TABLE<lectures> course_table;
+        RANKING ranking;
         int lecture_counter = 0;
+        int expected_classes = 0; // The number of classes every new course makes room for
 
     public:
-        Boom2();
-        ~Boom2() = default;
+        BasicBoom2();
+        ~BasicBoom2() = default;
 
+        void reserve(int courses, int classes_per_course);
         bool addCourse(int course_id);
         bool removeCourse(int course_id);
         bool addClass(int course_id, int* class_id);
         bool watchClass(int course_id, int class_id, int time);
         bool timeViewed(int course_id, int class_id, int* time_viewed);
         bool getIthWatchedClass(int i, int* course_id, int* class_id);
+        bool getWatchedClassesRange(int from, int to, int* course_ids, int* class_ids);
+        bool getIthWatchedClasses(const int* ranks, int count, int* course_ids, int* class_ids);
+        bool getRankOfClass(int course_id, int class_id, int* rank);
 
         class InvalidInput { };
     };
+
+    // The ranking is kept in a rank tree, unless BOOM2_BTREE_RANKING is defined,
+    // and the courses in a chain table, unless BOOM2_FLAT_COURSE_TABLE is defined.
+#ifdef BOOM2_BTREE_RANKING
+    typedef BTreeRanking Boom2Ranking;
+#else
+    typedef AVLRanking Boom2Ranking;
+#endif
+#ifdef BOOM2_FLAT_COURSE_TABLE
+    typedef BasicBoom2<Boom2Ranking, FlatCourseTable> Boom2;
+#else
+    typedef BasicBoom2<Boom2Ranking, ChainCourseTable> Boom2;
+#endif
 }
 #endif
\ No newline at end of file
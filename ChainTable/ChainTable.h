@@ -1,78 +1,200 @@
 #ifndef _CHAIN_TABLE_H
 #define _CHAIN_TABLE_H
 #include <math.h>
+#include <utility>
+#include "HashPolicies.h"
 #include "../DynamicArray/DynamicArray.h"
 #include "../RankAVL/AVL.h"
 #include "../Exceptions/Exceptions.h"
 
 namespace DS
 {
-    template<typename VAL_TYPE>
+    /*
+     * Class: ChainTable
+     * ---------------------------------------
+     * A hash table that chains the keys of every cell in an AVL tree.
+     * The keys and how they are spread over the cells are set by HASH (see HashPolicies.h).
+     * By default the keys are ints, hashed by Fibonacci hashing over a table whose size is a power of 2.
+     */
+    template<typename VAL_TYPE, class HASH=FibonacciHash<int>>
     class ChainTable
     {
     private:
+        typedef typename HASH::key_type KEY_TYPE;
+
         /*********************************/
         /*        Private Section        */
         /*********************************/
-        DynamicArray<AVL<int, VAL_TYPE>> table;
+        DynamicArray<AVL<KEY_TYPE, VAL_TYPE>> table;
+        // While the table is resized, the buckets of the previous table that were not moved yet.
+        // They are moved from the last one down, and old_table is truncated after each, so it only holds the ones left:
+        DynamicArray<AVL<KEY_TYPE, VAL_TYPE>> old_table;
+        int old_size; // The size of the previous table, which the keys in old_table are hashed by
+        int reserved; // The table is not shrunk below this many cells (see reserve)
         int elem_counter;
         bool already_expanded;
-        double ratio; // Hash function parameter (golden ratio)
+        bool migrating;
 
         /*   Private Static Variables   */
         static const int STRESS_CONTROL = 2; // elem_counter/size = alpha < STRESS_CONTROL
         static const int INIT_SIZE = 10; // Initial table size
+        static const int MIGRATE_STEP = 4; // The number of old buckets moved by every insert or erase
+        static const int BATCH_GROUP = 16; // The number of keys getBatch waits for memory for at once
         /*   Private Methods/Static Functions   */
-        // Gets a key as input and returns the matching index
-        int hash(double key) const
+        // Gets a key as input and returns the matching index in a table of table_size cells
+        static int hash(const KEY_TYPE& key, int table_size)
         {
-            return floor(table.size()*modf(key*ratio, &key));
+            return HASH::index(key, table_size);
         }
 
-        /* Makes a new hash table with new_size allocated cells.
-         * Returns false if was unable to create a new table. (due to allocation errors, etc.)
-         * The data structure will assume normal behavior until finally
-         * able to extend or shorten the table and fix the stress factor accordingly. 
-         */
-        bool remakeTable(int new_size)
+        int hash(const KEY_TYPE& key) const
         {
-            int table_size = table.size();
-            
-            class CopyToTable
+            return hash(key, table.size());
+        }
+
+        // Sets *array and *cell to where the bucket of key is: in the old table if it was not moved yet, or in the table otherwise.
+        void cellOf(const KEY_TYPE& key, const DynamicArray<AVL<KEY_TYPE, VAL_TYPE>>** array, int* cell) const
+        {
+            if(migrating)
             {
-            public:
-                ChainTable<VAL_TYPE> new_table;
-                explicit CopyToTable(int new_size) : new_table(ChainTable<VAL_TYPE>(new_size)) { }
-                void updateTableSize(int new_size)
+                int old_hashed = hash(key, old_size);
+                if(old_hashed < old_table.size())
                 {
-                    new_table = ChainTable<VAL_TYPE>(new_size);
+                    *array = &old_table;
+                    *cell = old_hashed;
+                    return;
                 }
-                void operator()(const std::shared_ptr<graph_node<int, VAL_TYPE>>& node, int* k)
+            }
+            *array = &table;
+            *cell = hash(key);
+        }
+
+        // Returns the bucket of key (see cellOf), or a null pointer if that bucket was never initialized.
+        const AVL<KEY_TYPE, VAL_TYPE>* bucketOf(const KEY_TYPE& key) const
+        {
+            const DynamicArray<AVL<KEY_TYPE, VAL_TYPE>>* array;
+            int cell;
+            cellOf(key, &array, &cell);
+            return array->isInitialized(cell)? &array->get(cell) : nullptr;
+        }
+
+        AVL<KEY_TYPE, VAL_TYPE>* bucketOf(const KEY_TYPE& key)
+        {
+            return const_cast<AVL<KEY_TYPE, VAL_TYPE>*>(static_cast<const ChainTable*>(this)->bucketOf(key));
+        }
+
+        // Returns the bucket of key like bucketOf, and initializes it if needed.
+        AVL<KEY_TYPE, VAL_TYPE>& bucketForInsert(const KEY_TYPE& key)
+        {
+            DynamicArray<AVL<KEY_TYPE, VAL_TYPE>>* target = &table;
+            int hashed = hash(key);
+            if(migrating)
+            {
+                int old_hashed = hash(key, old_size);
+                if(old_hashed < old_table.size())
                 {
-                    new_table.insert(node->key, node->val);
-                    (*k)--;
+                    target = &old_table;
+                    hashed = old_hashed;
                 }
-            };
+            }
+            if(!target->isInitialized(hashed))
+            {
+                target->store(hashed, AVL<KEY_TYPE, VAL_TYPE>());
+            }
+            return target->get(hashed);
+        }
 
-            CopyToTable functor(1);
-            try
+        // Returns the value of key, and inserts the value make() for it first if key is not in the table.
+        // *inserted is set to whether it was inserted.
+        template<class FACTORY>
+        VAL_TYPE& findOrInsertAux(const KEY_TYPE& key, FACTORY& make, bool* inserted)
+        {
+            migrate(MIGRATE_STEP);
+            AVL<KEY_TYPE, VAL_TYPE>& container = bucketForInsert(key);
+            VAL_TYPE* value = container.tryAt(key);
+            *inserted = !value;
+            if(!value)
             {
-                functor.updateTableSize(new_size);
+                container.insert(key, make());
+                elem_counter++;
+                fixStress(); // Only swaps the bucket arrays, so container is still where key is
+                value = container.tryAt(key);
             }
-            catch(const std::bad_alloc& e)
+            return *value;
+        }
+
+        // Inserts the pair (key, value) into the table, copying or moving value in. (if VAL is not a reference)
+        template<class VAL>
+        void insertAux(const KEY_TYPE& key, VAL&& value)
+        {
+            migrate(MIGRATE_STEP);
+            AVL<KEY_TYPE, VAL_TYPE>& container = bucketForInsert(key);
+            VAL_TYPE* existing = container.tryAt(key);
+            if(existing) // The key is already in the table => don't increment the element counter
             {
-                return false;
+                *existing = std::forward<VAL>(value);
             }
+            else // The key isn't in the table => add it, increment the element counter and fixStress
+            {
+                container.insert(key, std::forward<VAL>(value));
+                elem_counter++;
+                fixStress();
+            }
+        }
 
-            for(int i = 0; i < table_size; i++)
+        // Moves up to steps buckets of the old table into the table, and ends the resize once all of them moved.
+        // The nodes of the old buckets are relinked into the new ones, so no value is copied and nothing is allocated.
+        // Each old bucket is destroyed right after it is emptied, so ending the resize does not destroy the old table at once.
+        void migrate(int steps)
+        {
+            auto relink = [this](AVL<KEY_TYPE, VAL_TYPE>& from, const typename AVL<KEY_TYPE, VAL_TYPE>::link& node, const KEY_TYPE& key)
+            {
+                int hashed = hash(key);
+                if(!table.isInitialized(hashed))
+                {
+                    table.store(hashed, AVL<KEY_TYPE, VAL_TYPE>());
+                }
+                table.get(hashed).insertNode(from, node);
+            };
+            for(; migrating && steps > 0; steps--)
             {
-                AVL<int, VAL_TYPE>& container = table.get(i);
-                if(container.size())
+                int last = old_table.size() - 1;
+                if(old_table.isInitialized(last))
                 {
-                    container.inOrder(functor);
+                    old_table.get(last).extractAll(relink);
                 }
+                old_table.truncate(last);
+                migrating = last > 0;
             }
-            *this = functor.new_table;
+        }
+
+        /* Starts moving the elements into a new hash table with new_size allocated cells.
+         * The elements are moved a few buckets at a time by the following inserts and erases (see migrate),
+         * so no single operation pays for the whole resize, and no element moves during the operation that started it.
+         * The buckets of the new table are only constructed once a key is put in them (see DynamicArray),
+         * so starting the resize costs an allocation and not a pass over the new table.
+         * Returns false if was unable to create a new table. (due to allocation errors, etc.)
+         * The data structure will assume normal behavior until finally
+         * able to extend or shorten the table and fix the stress factor accordingly. 
+         */
+        bool remakeTable(int new_size)
+        {
+            if(migrating) // Only happens if the table changed size very fast. The new resize waits for the last one to end.
+            {
+                return true;
+            }
+            try
+            {
+                DynamicArray<AVL<KEY_TYPE, VAL_TYPE>> new_table(HASH::tableSize(new_size), AVL<KEY_TYPE, VAL_TYPE>(), 1);
+                table.swap(new_table);
+                old_table.swap(new_table); // new_table is left with the empty old_table of the last resize
+            }
+            catch(const std::bad_alloc& e)
+            {
+                return false;
+            }
+            old_size = old_table.size();
+            migrating = true;
             already_expanded = true;
             return true;
         }
@@ -83,11 +205,13 @@ namespace DS
             double stress_factor = static_cast<double>(elem_counter)/table_size;
             bool res = true;
             if((stress_factor >= STRESS_CONTROL) ||
-            ((table_size > INIT_SIZE) && already_expanded && (stress_factor < (static_cast<double>(STRESS_CONTROL)/4))))
+            ((table_size > INIT_SIZE) && (table_size > reserved) && already_expanded &&
+            (stress_factor < (static_cast<double>(STRESS_CONTROL)/4))))
             {
                 // The constant to multiply the current table size with to normalize the stress factor to (1/2)*STRESS_CONTROL:
                 double k = (2*static_cast<double>(elem_counter))/(STRESS_CONTROL*table_size);
-                res = remakeTable(ceil(static_cast<double>(table_size) * k));
+                int new_size = ceil(static_cast<double>(table_size) * k);
+                res = remakeTable(new_size > reserved? new_size : reserved);
             }
             return res;
         }
@@ -100,8 +224,9 @@ namespace DS
          * Constructor: ChainTable
          * Usage: ChainTable<VAL_TYPE> table;
          *        ChainTable<VAL_TYPE> table(init_size);
+         *        ChainTable<VAL_TYPE, HASH> table;
          * ---------------------------------------
-         * Creates an empty hash table with init_size pre-allocated cells.
+         * Creates an empty hash table with init_size pre-allocated cells. (rounded by HASH::tableSize)
          * If no init_size is inserted, assumes init_size = INIT_SIZE. (static var)
          * Worst time complexity: O(1)
          * 
@@ -109,18 +234,20 @@ namespace DS
          * std::bad_alloc
          */
         ChainTable() : 
-        table(DynamicArray<AVL<int, VAL_TYPE>>(INIT_SIZE, AVL<int, VAL_TYPE>(), 1)), elem_counter(0), already_expanded(false), ratio((sqrt(5) - 1)/2) { }
+        table(DynamicArray<AVL<KEY_TYPE, VAL_TYPE>>(HASH::tableSize(INIT_SIZE), AVL<KEY_TYPE, VAL_TYPE>(), 1)), old_table(DynamicArray<AVL<KEY_TYPE, VAL_TYPE>>(1, AVL<KEY_TYPE, VAL_TYPE>(), 1)),
+        old_size(0), reserved(0), elem_counter(0), already_expanded(false), migrating(false) { }
         ChainTable(int init_size) : 
-        table(DynamicArray<AVL<int, VAL_TYPE>>(init_size, AVL<int, VAL_TYPE>(), 1)), elem_counter(0), already_expanded(false), ratio((sqrt(5) - 1)/2) { }
+        table(DynamicArray<AVL<KEY_TYPE, VAL_TYPE>>(HASH::tableSize(init_size), AVL<KEY_TYPE, VAL_TYPE>(), 1)), old_table(DynamicArray<AVL<KEY_TYPE, VAL_TYPE>>(1, AVL<KEY_TYPE, VAL_TYPE>(), 1)),
+        old_size(0), reserved(0), elem_counter(0), already_expanded(false), migrating(false) { }
 
-        ChainTable(const ChainTable<VAL_TYPE>& other) = default;
+        ChainTable(const ChainTable<VAL_TYPE, HASH>& other) = default;
 
         virtual ~ChainTable() = default;
 
-        ChainTable<VAL_TYPE>& operator=(const ChainTable<VAL_TYPE>& other)
+        ChainTable<VAL_TYPE, HASH>& operator=(const ChainTable<VAL_TYPE, HASH>& other)
         {
             int new_table_size = other.table.size();
-            DynamicArray<AVL<int, VAL_TYPE>> new_table(new_table_size);
+            DynamicArray<AVL<KEY_TYPE, VAL_TYPE>> new_table(new_table_size);
             for(int i = 0; i < new_table_size; i++)
             {
                 if(other.table.isInitialized(i))
@@ -129,9 +256,12 @@ namespace DS
                 }
             }
             table = new_table;
+            old_table = other.old_table;
+            old_size = other.old_size;
+            reserved = other.reserved;
+            migrating = other.migrating;
             elem_counter = other.elem_counter;
             already_expanded = other.already_expanded;
-            ratio = other.ratio;
             return *this;
         }
 
@@ -139,31 +269,93 @@ namespace DS
          * Method: insert
          * Usage: table.insert(key, value);
          * ---------------------------------------
-         * Inserts the pair (key, value) into the table.
+         * Inserts the pair (key, value) into the table, or replaces the value of key if it is already there.
+         * An rvalue value is moved into the table rather than copied.
          * Average time complexity: O(1)
          * 
          * Possible Exceptions:
          * std::bad_alloc
          */
-        void insert(int key, const VAL_TYPE& value)
+        void insert(const KEY_TYPE& key, const VAL_TYPE& value)
         {
-            int hashed = hash(key);
-            if(!table.isInitialized(hashed))
+            insertAux(key, value);
+        }
+
+        void insert(const KEY_TYPE& key, VAL_TYPE&& value)
+        {
+            insertAux(key, std::move(value));
+        }
+
+        /*
+         * Method: reserve
+         * Usage: table.reserve(count);
+         * ---------------------------------------
+         * Makes room for count elements, so inserting up to count elements into the table does not resize it,
+         * and the table is not shrunk below that room later.
+         * The table is resized at once if needed, and any resize in progress is finished first.
+         * Worst time complexity: O(n + count)
+         * 
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        void reserve(int count)
+        {
+            int new_size = HASH::tableSize(count > 1? count : 1);
+            if(new_size > reserved)
             {
-                table.store(hashed, AVL<int, VAL_TYPE>());
+                reserved = new_size;
             }
-            AVL<int, VAL_TYPE>& container = table.get(hashed);
-            if(container.find(key)) // The key is already in the table => don't increment the element counter
+            if(new_size <= table.size())
             {
-                container.erase(key);
-                container.insert(key, value);
+                return;
             }
-            else // The key isn't in the table => add it, increment the element counter and fixStress
+            migrate(old_table.size());
+            if(!remakeTable(new_size))
             {
-                container.insert(key, value);
-                elem_counter++;
-                fixStress();
+                throw std::bad_alloc();
             }
+            migrate(old_table.size());
+        }
+
+        /*
+         * Method: findOrInsert
+         * Usage: table.findOrInsert(key, factory);
+         * ---------------------------------------
+         * Returns the value matching key in the table. If key is not in the table,
+         * inserts it first with the value factory() returns.
+         * The key is hashed and searched once.
+         * The reference is valid until the next insertion or removal.
+         * Average time complexity: O(1)
+         * 
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        template<class FACTORY>
+        VAL_TYPE& findOrInsert(const KEY_TYPE& key, FACTORY factory)
+        {
+            bool inserted;
+            return findOrInsertAux(key, factory, &inserted);
+        }
+
+        /*
+         * Method: emplace
+         * Usage: table.emplace(key, args...);
+         * ---------------------------------------
+         * Inserts key with the value VAL_TYPE(args...) if key is not in the table.
+         * Returns true if it was inserted, or false if key was already in the table. (and its value is kept)
+         * The key is hashed and searched once.
+         * Average time complexity: O(1)
+         * 
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        template<class... ARGS>
+        bool emplace(const KEY_TYPE& key, ARGS&&... args)
+        {
+            bool inserted;
+            auto make = [&]() { return VAL_TYPE(std::forward<ARGS>(args)...); };
+            findOrInsertAux(key, make, &inserted);
+            return inserted;
         }
 
         /*
@@ -173,21 +365,44 @@ namespace DS
          * Removes key and its contents from the table.
          * Average time complexity: O(1)
          */
-        void erase(int key)
+        void erase(const KEY_TYPE& key)
         {
-            if(!table.isInitialized(hash(key)))
+            migrate(MIGRATE_STEP);
+            AVL<KEY_TYPE, VAL_TYPE>* container = bucketOf(key);
+            if(container && container->find(key))
             {
-                return;
-            }
-            AVL<int, VAL_TYPE>& container = table.get(hash(key));
-            if(container.find(key))
-            {
-                container.erase(key);
+                container->erase(key);
                 elem_counter--;
                 fixStress();
             }
         }
 
+        /*
+         * Method: extract
+         * Usage: table.extract(key, sink);
+         * ---------------------------------------
+         * Removes key from the table like erase, but first calls sink(value) on the value matching it.
+         * Returns true if key was in the table, or false (and sink is not called) otherwise.
+         * The key is hashed and its bucket found once. (the tree of the bucket is walked to read the value and to erase it)
+         * Average time complexity: O(1 + O(sink))
+         */
+        template<class SINK>
+        bool extract(const KEY_TYPE& key, SINK sink)
+        {
+            migrate(MIGRATE_STEP);
+            AVL<KEY_TYPE, VAL_TYPE>* container = bucketOf(key);
+            VAL_TYPE* value = container? container->tryAt(key) : nullptr;
+            if(!value)
+            {
+                return false;
+            }
+            sink(*value);
+            container->erase(key);
+            elem_counter--;
+            fixStress();
+            return true;
+        }
+
         /*
          * Method: get
          * Usage: table.get(key);
@@ -198,18 +413,102 @@ namespace DS
          * Possible Exceptions:
          * KeyNotFound
          */
-        const VAL_TYPE& get(int key) const
+        const VAL_TYPE& get(const KEY_TYPE& key) const
         {
-            int hashed = hash(key);
-            return (table.get(hashed)).at(key);
+            const AVL<KEY_TYPE, VAL_TYPE>* container = bucketOf(key);
+            if(!container)
+            {
+                throw KeyNotFound();
+            }
+            return container->at(key);
         }
 
-        VAL_TYPE& get(int key)
+        VAL_TYPE& get(const KEY_TYPE& key)
         {
-            int hashed = hash(key);
-            return (table.get(hashed)).at(key);
+            AVL<KEY_TYPE, VAL_TYPE>* container = bucketOf(key);
+            if(!container)
+            {
+                throw KeyNotFound();
+            }
+            return container->at(key);
         }
         
+        /*
+         * Method: tryGet
+         * Usage: table.tryGet(key);
+         * ---------------------------------------
+         * Returns a pointer to the value matching key in the table, or a null pointer if key is not in the table.
+         * The pointer is valid until the next insertion or removal.
+         * Average time complexity: O(1)
+         */
+        const VAL_TYPE* tryGet(const KEY_TYPE& key) const
+        {
+            const AVL<KEY_TYPE, VAL_TYPE>* container = bucketOf(key);
+            return container? container->tryAt(key) : nullptr;
+        }
+
+        VAL_TYPE* tryGet(const KEY_TYPE& key)
+        {
+            AVL<KEY_TYPE, VAL_TYPE>* container = bucketOf(key);
+            return container? container->tryAt(key) : nullptr;
+        }
+
+        /*
+         * Method: getBatch
+         * Usage: table.getBatch(keys, count, out);
+         * ---------------------------------------
+         * Looks up count keys at once: out[i] is set to a pointer to the value matching keys[i],
+         * or to a null pointer if keys[i] is not in the table, like tryGet.
+         * The keys are handled in groups of BATCH_GROUP. Each group is hashed first and the memory its buckets are in
+         * is prefetched in a few passes, one dependent load at a time, before any of its keys is searched.
+         * So the cache misses of a group overlap instead of each lookup waiting for its own.
+         * The pointers are valid until the next insertion or removal.
+         * Average time complexity: O(count)
+         */
+        void getBatch(const KEY_TYPE* keys, int count, const VAL_TYPE** out) const
+        {
+            const DynamicArray<AVL<KEY_TYPE, VAL_TYPE>>* arrays[BATCH_GROUP];
+            int cells[BATCH_GROUP];
+            const AVL<KEY_TYPE, VAL_TYPE>* buckets[BATCH_GROUP];
+            for(int first = 0; first < count; first += BATCH_GROUP)
+            {
+                int group = count - first < BATCH_GROUP? count - first : BATCH_GROUP;
+                for(int i = 0; i < group; i++)
+                {
+                    cellOf(keys[first + i], &arrays[i], &cells[i]);
+                    arrays[i]->prefetch(cells[i]);
+                }
+                for(int i = 0; i < group; i++)
+                {
+                    arrays[i]->prefetchInitialized(cells[i]);
+                }
+                for(int i = 0; i < group; i++)
+                {
+                    buckets[i] = arrays[i]->isInitialized(cells[i])? &arrays[i]->get(cells[i]) : nullptr;
+                    if(buckets[i])
+                    {
+                        buckets[i]->prefetchRoot();
+                    }
+                }
+                for(int i = 0; i < group; i++)
+                {
+                    if(buckets[i])
+                    {
+                        buckets[i]->prefetchChild(keys[first + i]);
+                    }
+                }
+                for(int i = 0; i < group; i++)
+                {
+                    out[first + i] = buckets[i]? buckets[i]->tryAt(keys[first + i]) : nullptr;
+                }
+            }
+        }
+
+        void getBatch(const KEY_TYPE* keys, int count, VAL_TYPE** out)
+        {
+            static_cast<const ChainTable*>(this)->getBatch(keys, count, const_cast<const VAL_TYPE**>(out));
+        }
+
         /*
          * Method: find
          * Usage: table.find(key);
@@ -217,9 +516,10 @@ namespace DS
          * Returns a bool value indicating if key is in the table.
          * Average time complexity: O(1)
          */
-        bool find(int key) const
+        bool find(const KEY_TYPE& key) const
         {
-            return (table.get(hash(key))).find(key);
+            const AVL<KEY_TYPE, VAL_TYPE>* container = bucketOf(key);
+            return container && container->find(key);
         }
 
         /*
@@ -0,0 +1,647 @@
+#ifndef _CONCURRENT_CHAIN_TABLE_H
+#define _CONCURRENT_CHAIN_TABLE_H
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <new>
+#include <stdint.h>
+#include <thread>
+#include <utility>
+#include "HashPolicies.h"
+#include "../Exceptions/Exceptions.h"
+
+namespace DS
+{
+    /*
+     * Class: ConcurrentChainTable
+     * ---------------------------------------
+     * A hash table that can be used from many threads at once.
+     * The keys are split between SHARDS shards (a power of 2) by the top bits of their hash, and every shard
+     * is a chained hash table with a lock of its own, so it is written and resized independently of the others.
+     * Reads (get, find, read) take no lock and never wait. A node is never changed once other threads can see it:
+     * writes (insert, emplace, erase, update) link a new node in place of the old one, and the old node is
+     * freed only after every read that may still see it is done. (see synchronize)
+     * Since another thread may replace a value at any time, values are handed out by copy (get)
+     * or visited (read, update) rather than returned by reference.
+     */
+    template<typename VAL_TYPE, class HASH=FibonacciHash<int>, int SHARDS=64>
+    class ConcurrentChainTable
+    {
+        static_assert(SHARDS > 0 && (SHARDS & (SHARDS - 1)) == 0, "SHARDS must be a power of 2");
+
+    private:
+        typedef typename HASH::key_type KEY_TYPE;
+
+        /*********************************/
+        /*        Private Section        */
+        /*********************************/
+        // Spreads the keys of a shard over its table by the hash bits that follow the ones that picked the shard,
+        // which are the same for every key in the shard.
+        struct ShardHash
+        {
+            typedef typename HASH::key_type key_type;
+
+            static int tableSize(int requested)
+            {
+                return HASH::tableSize(requested);
+            }
+
+            static int index(const key_type& key, int table_size)
+            {
+                long long spread = static_cast<long long>(table_size) * SHARDS;
+                if(spread > INT_MAX) // A huge shard is spread over as many of the following bits as an int can index
+                {
+                    spread = table_size;
+                    while(spread * 2 <= INT_MAX)
+                    {
+                        spread *= 2;
+                    }
+                }
+                return HASH::index(key, static_cast<int>(spread)) % table_size;
+            }
+        };
+
+        // A spin lock, held by the writers of a shard.
+        class SpinLock
+        {
+        private:
+            std::atomic<bool> locked;
+
+        public:
+            SpinLock() : locked(false) { }
+
+            void lock()
+            {
+                while(locked.exchange(true, std::memory_order_acquire))
+                {
+                    while(locked.load(std::memory_order_relaxed))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+
+            void unlock()
+            {
+                locked.store(false, std::memory_order_release);
+            }
+        };
+
+        // Holds a spin lock for the scope it is declared in.
+        class LockGuard
+        {
+        private:
+            SpinLock& lock;
+        public:
+            explicit LockGuard(SpinLock& lock) : lock(lock) { lock.lock(); }
+            ~LockGuard() { lock.unlock(); }
+        };
+
+        // A pair of the table. Once it is linked into a chain, only its next link changes.
+        struct Node
+        {
+            const KEY_TYPE key;
+            VAL_TYPE value;
+            std::atomic<Node*> next;
+            Node* retired_next; // The next node waiting to be freed (see retire)
+
+            template<class... ARGS>
+            explicit Node(const KEY_TYPE& key, ARGS&&... args) :
+            key(key), value(std::forward<ARGS>(args)...), next(nullptr), retired_next(nullptr) { }
+        };
+
+        // The cells of a shard, each holding a chain of nodes.
+        struct Buckets
+        {
+            const int size;
+            std::atomic<Node*>* const cells;
+
+            explicit Buckets(int size) : size(size), cells(new std::atomic<Node*>[size])
+            {
+                for(int i = 0; i < size; i++)
+                {
+                    cells[i].store(nullptr, std::memory_order_relaxed);
+                }
+            }
+
+            Buckets(const Buckets& other) = delete;
+            Buckets& operator=(const Buckets& other) = delete;
+
+            ~Buckets()
+            {
+                delete[] cells;
+            }
+
+            // Frees every node in the chains.
+            void clear()
+            {
+                for(int i = 0; i < size; i++)
+                {
+                    Node* node = cells[i].load(std::memory_order_relaxed);
+                    while(node)
+                    {
+                        Node* next = node->next.load(std::memory_order_relaxed);
+                        delete node;
+                        node = next;
+                    }
+                }
+            }
+        };
+
+        /*   Private Static Variables   */
+        static const int CACHE_LINE = 64;
+        static const int STRESS_CONTROL = 2; // count/size = alpha < STRESS_CONTROL in every shard
+        static const int INIT_SIZE = 8; // Initial table size of a shard
+        static const int RETIRE_BATCH = 64; // The number of nodes a shard unlinks before it waits for the readers to free them
+        static const int READER_SLOTS = 64; // The number of cache lines the readers are counted in
+
+        // Every shard takes whole cache lines, so threads that work on different shards do not share any.
+        struct alignas(CACHE_LINE) Shard
+        {
+            SpinLock lock;
+            std::atomic<Buckets*> buckets;
+            std::atomic<int> count;
+            Node* retired; // The nodes unlinked from the shard that reads may still see
+            int retired_count;
+
+            Shard() : buckets(new Buckets(ShardHash::tableSize(INIT_SIZE))), count(0), retired(nullptr), retired_count(0) { }
+
+            ~Shard()
+            {
+                Buckets* current = buckets.load(std::memory_order_relaxed);
+                current->clear();
+                delete current;
+                freeRetired();
+            }
+
+            void freeRetired()
+            {
+                while(retired)
+                {
+                    Node* next = retired->retired_next;
+                    delete retired;
+                    retired = next;
+                }
+                retired_count = 0;
+            }
+        };
+
+        // The number of reads running right now, by the parity of the epoch they started in.
+        // Every thread counts its reads in one slot, so threads only share a slot when there are more than READER_SLOTS.
+        struct alignas(CACHE_LINE) ReaderSlot
+        {
+            std::atomic<int> active[2];
+
+            ReaderSlot()
+            {
+                active[0].store(0, std::memory_order_relaxed);
+                active[1].store(0, std::memory_order_relaxed);
+            }
+        };
+
+        Shard shards[SHARDS];
+        mutable ReaderSlot readers[READER_SLOTS];
+        alignas(CACHE_LINE) std::atomic<unsigned> epoch;
+        SpinLock epoch_lock; // Held while waiting for the reads, so the epoch moves once at a time
+
+        static int readerSlot()
+        {
+            static std::atomic<int> threads(0);
+            static thread_local int slot = threads.fetch_add(1, std::memory_order_relaxed) % READER_SLOTS;
+            return slot;
+        }
+
+        // Counts the calling thread as reading in the current epoch, for the scope it is declared in.
+        // If the epoch moved on while the read was counted, it is counted again, so synchronize never misses it.
+        class ReadGuard
+        {
+        private:
+            std::atomic<int>* active;
+        public:
+            explicit ReadGuard(const ConcurrentChainTable& table)
+            {
+                ReaderSlot& slot = table.readers[readerSlot()];
+                while(true)
+                {
+                    unsigned current = table.epoch.load();
+                    active = &slot.active[current & 1];
+                    active->fetch_add(1);
+                    if(table.epoch.load() == current)
+                    {
+                        return;
+                    }
+                    active->fetch_sub(1);
+                }
+            }
+
+            ~ReadGuard() { active->fetch_sub(1, std::memory_order_release); }
+        };
+
+        Shard& shardOf(const KEY_TYPE& key)
+        {
+            return shards[HASH::index(key, SHARDS)];
+        }
+
+        const Shard& shardOf(const KEY_TYPE& key) const
+        {
+            return shards[HASH::index(key, SHARDS)];
+        }
+
+        // Returns the node of key, or nullptr if key is not in the table. The caller must hold a ReadGuard.
+        const Node* findNode(const KEY_TYPE& key) const
+        {
+            const Buckets* buckets = shardOf(key).buckets.load(std::memory_order_acquire);
+            const Node* node = buckets->cells[ShardHash::index(key, buckets->size)].load(std::memory_order_acquire);
+            while(node && !(node->key == key))
+            {
+                node = node->next.load(std::memory_order_acquire);
+            }
+            return node;
+        }
+
+        // Returns the link that points to the node of key, or nullptr if key is not in the shard.
+        // The caller must hold the lock of the shard.
+        static std::atomic<Node*>* findLink(Shard& shard, const KEY_TYPE& key)
+        {
+            Buckets* buckets = shard.buckets.load(std::memory_order_relaxed);
+            std::atomic<Node*>* link = &buckets->cells[ShardHash::index(key, buckets->size)];
+            for(Node* node = link->load(std::memory_order_relaxed); node; node = link->load(std::memory_order_relaxed))
+            {
+                if(node->key == key)
+                {
+                    return link;
+                }
+                link = &node->next;
+            }
+            return nullptr;
+        }
+
+        // Waits until every read that started before the call is done.
+        // No read after the call can reach a node that was unlinked before it, so such nodes can then be freed.
+        void synchronize()
+        {
+            LockGuard guard(epoch_lock);
+            unsigned previous = epoch.load(std::memory_order_relaxed);
+            epoch.store(previous + 1);
+            for(int i = 0; i < READER_SLOTS; i++)
+            {
+                while(readers[i].active[previous & 1].load() != 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        // Frees node, which was unlinked from shard, once no read can see it.
+        // The nodes are freed in batches, so only one in RETIRE_BATCH writes waits for the reads.
+        void retire(Shard& shard, Node* node)
+        {
+            node->retired_next = shard.retired;
+            shard.retired = node;
+            if(++shard.retired_count >= RETIRE_BATCH)
+            {
+                synchronize();
+                shard.freeRetired();
+            }
+        }
+
+        // Links fresh in place of the node that link points to, and retires that node.
+        void replaceNode(Shard& shard, std::atomic<Node*>* link, Node* fresh)
+        {
+            Node* old = link->load(std::memory_order_relaxed);
+            fresh->next.store(old->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            link->store(fresh, std::memory_order_release);
+            retire(shard, old);
+        }
+
+        // Links fresh, whose key is not in shard, at the head of its chain.
+        void linkNode(Shard& shard, Node* fresh)
+        {
+            Buckets* buckets = shard.buckets.load(std::memory_order_relaxed);
+            std::atomic<Node*>& cell = buckets->cells[ShardHash::index(fresh->key, buckets->size)];
+            fresh->next.store(cell.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            cell.store(fresh, std::memory_order_release);
+            shard.count.store(shard.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            fixStress(shard);
+        }
+
+        // Resizes the table of shard if its stress factor left [STRESS_CONTROL/4, STRESS_CONTROL).
+        void fixStress(Shard& shard)
+        {
+            int count = shard.count.load(std::memory_order_relaxed);
+            int table_size = shard.buckets.load(std::memory_order_relaxed)->size;
+            if(count >= STRESS_CONTROL * table_size || (table_size > INIT_SIZE && count * 4 < STRESS_CONTROL * table_size))
+            {
+                remakeTable(shard, count > INIT_SIZE? count : INIT_SIZE);
+            }
+        }
+
+        // Moves the pairs of shard into a table of about new_size cells.
+        // Reads may still be walking the old chains, so the pairs are copied into new nodes rather than relinked,
+        // and the old nodes are freed once the new table is published and those reads are done.
+        // If there is no memory for the new table, the shard keeps the old one.
+        void remakeTable(Shard& shard, int new_size)
+        {
+            Buckets* old = shard.buckets.load(std::memory_order_relaxed);
+            Buckets* fresh = nullptr;
+            try
+            {
+                fresh = new Buckets(ShardHash::tableSize(new_size));
+                for(int i = 0; i < old->size; i++)
+                {
+                    for(Node* node = old->cells[i].load(std::memory_order_relaxed); node; node = node->next.load(std::memory_order_relaxed))
+                    {
+                        Node* copy = new Node(node->key, node->value);
+                        std::atomic<Node*>& cell = fresh->cells[ShardHash::index(copy->key, fresh->size)];
+                        copy->next.store(cell.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                        cell.store(copy, std::memory_order_relaxed);
+                    }
+                }
+            }
+            catch(const std::bad_alloc& e)
+            {
+                if(fresh)
+                {
+                    fresh->clear();
+                    delete fresh;
+                }
+                return;
+            }
+            shard.buckets.store(fresh, std::memory_order_release);
+            synchronize();
+            old->clear();
+            delete old;
+            shard.freeRetired();
+        }
+
+        template<class VALUE>
+        void insertAux(const KEY_TYPE& key, VALUE&& value)
+        {
+            Shard& shard = shardOf(key);
+            LockGuard guard(shard.lock);
+            Node* fresh = new Node(key, std::forward<VALUE>(value));
+            std::atomic<Node*>* link = findLink(shard, key);
+            if(link)
+            {
+                replaceNode(shard, link, fresh);
+            }
+            else
+            {
+                linkNode(shard, fresh);
+            }
+        }
+
+        // Before C++17, new ignores the cache line alignment of the shards, so the table aligns itself:
+        // the block is over-allocated and the pointer operator new got is kept just before the aligned table.
+        static void* allocateAligned(std::size_t size)
+        {
+            void* raw = ::operator new(size + sizeof(void*) + CACHE_LINE - 1);
+            uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + CACHE_LINE - 1) & ~uintptr_t(CACHE_LINE - 1);
+            reinterpret_cast<void**>(aligned)[-1] = raw;
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        static void freeAligned(void* ptr)
+        {
+            if(ptr)
+            {
+                ::operator delete(static_cast<void**>(ptr)[-1]);
+            }
+        }
+
+    public:
+        /**********************************/
+        /*         Public Section         */
+        /**********************************/
+        /*
+         * Constructor: ConcurrentChainTable
+         * Usage: ConcurrentChainTable<VAL_TYPE> table;
+         *        ConcurrentChainTable<VAL_TYPE, HASH, SHARDS> table;
+         * ---------------------------------------
+         * Creates an empty hash table of SHARDS empty shards.
+         * The table can not be copied, since other threads may be using it.
+         * Worst time complexity: O(SHARDS)
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        ConcurrentChainTable() : epoch(0) { }
+        ConcurrentChainTable(const ConcurrentChainTable& other) = delete;
+        ConcurrentChainTable& operator=(const ConcurrentChainTable& other) = delete;
+
+        /*
+         * Method: operator new
+         * Usage: new ConcurrentChainTable<VAL_TYPE>();
+         * ---------------------------------------
+         * Allocates tables aligned to cache lines, like the shards in them, in any C++ version.
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        static void* operator new(std::size_t size)
+        {
+            return allocateAligned(size);
+        }
+
+        static void* operator new[](std::size_t size)
+        {
+            return allocateAligned(size);
+        }
+
+        static void operator delete(void* ptr)
+        {
+            freeAligned(ptr);
+        }
+
+        static void operator delete[](void* ptr)
+        {
+            freeAligned(ptr);
+        }
+
+        /*
+         * Method: insert
+         * Usage: table.insert(key, value);
+         * ---------------------------------------
+         * Inserts the pair (key, value) into the table, or replaces the value of key if it is already there.
+         * An rvalue value is moved into the table rather than copied.
+         * Average time complexity: O(1)
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        void insert(const KEY_TYPE& key, const VAL_TYPE& value)
+        {
+            insertAux(key, value);
+        }
+
+        void insert(const KEY_TYPE& key, VAL_TYPE&& value)
+        {
+            insertAux(key, std::move(value));
+        }
+
+        /*
+         * Method: emplace
+         * Usage: table.emplace(key, args...);
+         * ---------------------------------------
+         * Inserts key with the value VAL_TYPE(args...) if key is not in the table.
+         * Returns true if it was inserted, or false if key was already in the table. (and its value is kept)
+         * Average time complexity: O(1)
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        template<class... ARGS>
+        bool emplace(const KEY_TYPE& key, ARGS&&... args)
+        {
+            Shard& shard = shardOf(key);
+            LockGuard guard(shard.lock);
+            if(findLink(shard, key))
+            {
+                return false;
+            }
+            linkNode(shard, new Node(key, std::forward<ARGS>(args)...));
+            return true;
+        }
+
+        /*
+         * Method: erase
+         * Usage: table.erase(key);
+         * ---------------------------------------
+         * Removes key and its contents from the table.
+         * Average time complexity: O(1)
+         */
+        void erase(const KEY_TYPE& key)
+        {
+            Shard& shard = shardOf(key);
+            LockGuard guard(shard.lock);
+            std::atomic<Node*>* link = findLink(shard, key);
+            if(!link)
+            {
+                return;
+            }
+            Node* node = link->load(std::memory_order_relaxed);
+            link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+            shard.count.store(shard.count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+            retire(shard, node);
+            fixStress(shard);
+        }
+
+        /*
+         * Method: update
+         * Usage: table.update(key, func);
+         * ---------------------------------------
+         * Calls func(value) with a copy of the value matching key, and puts the copy in its place.
+         * No other thread writes key meanwhile, and reads see either the old value or the new one.
+         * Returns false (without calling func) if key is not in the table.
+         * func must not use the table.
+         * Average time complexity: O(1), besides the call to func.
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        template<class FUNCTOR>
+        bool update(const KEY_TYPE& key, FUNCTOR func)
+        {
+            Shard& shard = shardOf(key);
+            LockGuard guard(shard.lock);
+            std::atomic<Node*>* link = findLink(shard, key);
+            if(!link)
+            {
+                return false;
+            }
+            Node* fresh = new Node(key, link->load(std::memory_order_relaxed)->value);
+            try
+            {
+                func(fresh->value);
+            }
+            catch(...)
+            {
+                delete fresh;
+                throw;
+            }
+            replaceNode(shard, link, fresh);
+            return true;
+        }
+
+        /*
+         * Method: read
+         * Usage: table.read(key, func);
+         * ---------------------------------------
+         * Calls func(value) with a const reference to the value matching key, without taking any lock.
+         * The value is never changed in place, so func sees all of it as it was, even if another thread replaces it meanwhile.
+         * Returns false (without calling func) if key is not in the table.
+         * func must not use the table, and the reference is only valid until func returns.
+         * Average time complexity: O(1), besides the call to func.
+         */
+        template<class FUNCTOR>
+        bool read(const KEY_TYPE& key, FUNCTOR func) const
+        {
+            ReadGuard guard(*this);
+            const Node* node = findNode(key);
+            if(!node)
+            {
+                return false;
+            }
+            func(node->value);
+            return true;
+        }
+
+        /*
+         * Method: get
+         * Usage: table.get(key);
+         * ---------------------------------------
+         * Returns a copy of the value matching key in the table, without taking any lock.
+         * Average time complexity: O(1)
+         *
+         * Possible Exceptions:
+         * KeyNotFound
+         */
+        VAL_TYPE get(const KEY_TYPE& key) const
+        {
+            ReadGuard guard(*this);
+            const Node* node = findNode(key);
+            if(!node)
+            {
+                throw KeyNotFound();
+            }
+            return node->value;
+        }
+
+        /*
+         * Method: find
+         * Usage: table.find(key);
+         * ---------------------------------------
+         * Returns a bool value indicating if key is in the table, without taking any lock.
+         * Average time complexity: O(1)
+         */
+        bool find(const KEY_TYPE& key) const
+        {
+            ReadGuard guard(*this);
+            return findNode(key) != nullptr;
+        }
+
+        /*
+         * Method: size
+         * Usage: table.size();
+         * -----------------------------------
+         * Returns the number of elements in the table.
+         * The shards are counted one after the other, so while other threads write to the table,
+         * the result is only a snapshot of each shard at a different time.
+         * Worst time complexity: O(SHARDS)
+         *
+         * Possible exceptions:
+         * No exception.
+         */
+        int size() const
+        {
+            int total = 0;
+            for(int i = 0; i < SHARDS; i++)
+            {
+                total += shards[i].count.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+    };
+}
+
+#endif
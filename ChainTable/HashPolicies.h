@@ -0,0 +1,104 @@
+#ifndef _HASH_POLICIES_H
+#define _HASH_POLICIES_H
+#include <math.h>
+#include <stdint.h>
+#include <new>
+
+namespace DS
+{
+    /*
+     * Hash policies
+     * ---------------------------------------
+     * A hash policy tells ChainTable what its keys are and how to spread them over the table. Every policy exposes:
+     *   key_type                    - The type of the keys. (the bucket trees compare them with <, >, == and !=)
+     *   tableSize(requested)        - The number of cells to allocate when the table asks for requested cells.
+     *                                 (throws std::bad_alloc if no table size it supports is close enough)
+     *   index(key, table_size)      - The cell of key, in [0, table_size), for a table_size given by tableSize.
+     * A policy for 64 bit or composite keys only has to provide these three:
+     *     struct PairHash
+     *     {
+     *         typedef std::pair<int, int> key_type;
+     *         static int tableSize(int requested) { return FibonacciHash<>::tableSize(requested); }
+     *         static int index(const key_type& key, int table_size)
+     *         {
+     *             return FibonacciHash<uint64_t>::index(uint64_t(uint32_t(key.first)) << 32 | uint32_t(key.second), table_size);
+     *         }
+     *     };
+     *     ChainTable<VAL_TYPE, PairHash> table;
+     */
+
+    // Fibonacci (multiplicative) hashing over tables whose size is a power of 2:
+    // the key is multiplied by 2^64 divided by the golden ratio, and the top bits of the product pick the cell.
+    // Works for any integral key of up to 64 bits.
+    template<typename KEY_TYPE=int>
+    struct FibonacciHash
+    {
+        typedef KEY_TYPE key_type;
+
+        // The largest power of 2 an int can hold.
+        static const int MAX_SIZE = 1 << 30;
+
+        // Returns the power of 2 closest to requested (by ratio).
+        // Throws std::bad_alloc if even MAX_SIZE is too far below requested.
+        static int tableSize(int requested)
+        {
+            if(requested > MAX_SIZE * 1.4142)
+            {
+                throw std::bad_alloc();
+            }
+            int size = 1;
+            while(size < requested && size < MAX_SIZE)
+            {
+                size *= 2;
+            }
+            if(size > 1 && requested * 1.4142 < size)
+            {
+                size /= 2;
+            }
+            return size;
+        }
+
+        static int index(const KEY_TYPE& key, int table_size)
+        {
+            uint64_t hashed = uint64_t(key) * 11400714819323198485ull;
+            return table_size == 1? 0 : int(hashed >> (64 - log2(table_size)));
+        }
+
+    private:
+        static int log2(int power)
+        {
+#ifdef __GNUC__
+            return __builtin_ctz(power);
+#else
+            int bits = 0;
+            while(power > 1)
+            {
+                power /= 2;
+                bits++;
+            }
+            return bits;
+#endif
+        }
+    };
+
+    // The original input averaged hash function: the fraction of key times the golden ratio, scaled to the table.
+    // Works for any table size.
+    template<typename KEY_TYPE=int>
+    struct GoldenRatioHash
+    {
+        typedef KEY_TYPE key_type;
+
+        static int tableSize(int requested)
+        {
+            return requested;
+        }
+
+        static int index(const KEY_TYPE& key, int table_size)
+        {
+            double whole;
+            return floor(table_size*modf(double(key)*((sqrt(5) - 1)/2), &whole));
+        }
+    };
+}
+
+#endif
@@ -40,7 +40,7 @@ namespace DS
          * Possible exceptions:
          * No assignment operator to class T, std::bad_aloc
          */
-        Array(const Array& arr) : max_size(arr.size())
+        Array(const Array& arr) : data(nullptr), max_size(arr.size())
         {
             T* new_data = new T[arr.size()];
             try
@@ -53,9 +53,21 @@ namespace DS
                 delete[] new_data;
                 throw;
             }
-            delete[] data;
             data = new_data;
         }
+
+        /*
+         * Move Constructor: Array<T>
+         * Usage: Array<T> new_array = std::move(arr);
+         * --------------------------------
+         * Initializes a new Array that takes over the elements of arr, without copying them.
+         * arr is left empty.
+         */
+        Array(Array&& arr) noexcept : data(arr.data), max_size(arr.max_size)
+        {
+            arr.data = nullptr;
+            arr.max_size = 0;
+        }
         
         /*
          * Destructor: ~Array<T>
@@ -101,6 +113,36 @@ namespace DS
             return *this;
         }
 
+        // Takes over the elements of target_arr without copying them, and frees the old ones.
+        Array& operator=(Array&& target_arr) noexcept
+        {
+            if (this != &target_arr)
+            {
+                delete[] data;
+                data = target_arr.data;
+                max_size = target_arr.max_size;
+                target_arr.data = nullptr;
+                target_arr.max_size = 0;
+            }
+            return *this;
+        }
+
+        /*
+         * Method: swap
+         * Usage: this_arr.swap(other);
+         * -----------------------------------
+         * Swaps the elements of the two arrays, without copying them.
+         */
+        void swap(Array& other) noexcept
+        {
+            T* temp_data = data;
+            data = other.data;
+            other.data = temp_data;
+            int temp_size = max_size;
+            max_size = other.max_size;
+            other.max_size = temp_size;
+        }
+
         /*
          * Method: size
          * Usage: int size = this_arr.size();
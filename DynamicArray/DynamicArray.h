@@ -1,18 +1,90 @@
 #ifndef _DYNAMIC_ARRAY_H
 #define _DYNAMIC_ARRAY_H
 #include <cassert>
+#include <climits>
+#include <cstddef>
+#include <new>
+#include <utility>
 #include "Array.h"
 #include "../Exceptions/Exceptions.h"
 
 namespace DS
 {
-    template<typename VAL_TYPE>
+    /*
+     * Class: DynamicArray
+     * ---------------------------------------
+     * An array whose cells are initialized in O(1), and which grows by realloc_factor once all of them are.
+     * A cell is only constructed when it is first stored into, so creating the array does not construct
+     * size() values, and destroying it only destroys the cells that were initialized.
+     * With INCREMENTAL_GROWTH, growing only allocates the larger array, and the cells are moved into it
+     * MIGRATE_STEP at a time by the following stores and gets, so no single operation moves them all.
+     */
+    template<typename VAL_TYPE, bool INCREMENTAL_GROWTH = false>
     class DynamicArray
     {
     protected:
-        Array<VAL_TYPE> values;
+        // Memory for count values, which are constructed and destroyed by the DynamicArray that owns it.
+        class Cells
+        {
+        private:
+            VAL_TYPE* data;
+            int count;
+        public:
+            explicit Cells(int count = 0) :
+            data(count? static_cast<VAL_TYPE*>(::operator new(sizeof(VAL_TYPE) * count)) : nullptr), count(count) { }
+
+            Cells(Cells&& other) noexcept : data(other.data), count(other.count)
+            {
+                other.data = nullptr;
+                other.count = 0;
+            }
+
+            Cells(const Cells& other) = delete;
+            Cells& operator=(const Cells& other) = delete;
+
+            ~Cells()
+            {
+                ::operator delete(data);
+            }
+
+            void swap(Cells& other) noexcept
+            {
+                std::swap(data, other.data);
+                std::swap(count, other.count);
+            }
+
+            int size() const noexcept
+            {
+                return count;
+            }
+
+            // Only the first new_count cells are used from now on. The memory stays allocated.
+            void shrink(int new_count) noexcept
+            {
+                count = new_count;
+            }
+
+            VAL_TYPE& operator[](int i)
+            {
+                return data[i];
+            }
+
+            const VAL_TYPE& operator[](int i) const
+            {
+                return data[i];
+            }
+        };
+        static_assert(alignof(VAL_TYPE) <= alignof(std::max_align_t), "Cells are allocated with the default alignment");
+
+        Cells values;
+        // While an incremental growth is in progress, the previous array. Its cells from migrated on were not moved yet:
+        Cells old_values;
+        int migrated;
+        // The cells below dense are all initialized. The cells from dense on are tracked by B (indexed by i - dense)
+        // and index_stack, which only hold entries for them:
         Array<int> B;
         Array<int> index_stack;
+        int dense; // The number of leading cells that are known to be initialized
         int top = 0; // The next index_stack index to write into
         int num_initialized; // Number of initialized elements
         int max_size; // Size of the current array
@@ -20,6 +92,8 @@ namespace DS
 
         int realloc_factor;
 
+        static const int MIGRATE_STEP = 2; // The number of cells moved by every store and get during an incremental growth
+
         /***********************************/
         /*        Protected Section        */
         /***********************************/
@@ -28,6 +102,127 @@ namespace DS
         {
             return a >= b? a : b;
         }
+
+        // Returns the cell i, in the previous array if it was not moved yet.
+        VAL_TYPE& cell(int i)
+        {
+            return (INCREMENTAL_GROWTH && i >= migrated && i < old_values.size())? old_values[i] : values[i];
+        }
+
+        const VAL_TYPE& cell(int i) const
+        {
+            return (INCREMENTAL_GROWTH && i >= migrated && i < old_values.size())? old_values[i] : values[i];
+        }
+
+        // Constructs the value of the cell *to from the cell *from, and destroys *from.
+        static void moveCell(VAL_TYPE& from, VAL_TYPE& to)
+        {
+            new (&to) VAL_TYPE(std::move(from));
+            from.~VAL_TYPE();
+        }
+
+        // Calls func(i) for every initialized cell i.
+        template<class FUNCTOR>
+        void forInitialized(FUNCTOR func) const
+        {
+            for(int i = 0; i < dense; i++)
+            {
+                func(i);
+            }
+            for(int j = 0; j < top; j++)
+            {
+                func(index_stack[j]);
+            }
+        }
+
+        // Moves up to steps cells of the previous array into the array, and frees it once all of them moved.
+        void migrate(int steps)
+        {
+            if(!INCREMENTAL_GROWTH || old_values.size() == 0)
+            {
+                return;
+            }
+            int end = old_values.size() - migrated > steps? migrated + steps : old_values.size();
+            for(; migrated < end; migrated++)
+            {
+                moveCell(old_values[migrated], values[migrated]);
+            }
+            if(migrated == old_values.size())
+            {
+                Cells empty;
+                old_values.swap(empty);
+                migrated = 0;
+            }
+        }
+
+        void finishMigration()
+        {
+            migrate(old_values.size());
+        }
+
+        // Starts growing a full array into one of new_size cells: every old cell becomes dense,
+        // and only the allocation is done now. (see migrate)
+        void startGrowth(int new_size)
+        {
+            finishMigration(); // Only happens if the array grew again very fast
+            Cells new_values(new_size);
+            Array<int> new_B(new_size - max_size);
+            Array<int> new_stack(new_size - max_size);
+            values.swap(new_values);
+            old_values.swap(new_values);
+            B.swap(new_B);
+            index_stack.swap(new_stack);
+            migrated = 0;
+            dense = max_size;
+            top = 0;
+            max_size = new_size;
+        }
+
+        // Once every cell is initialized, B and index_stack are not needed to tell so, and are freed.
+        void dropInitData()
+        {
+            dense = max_size;
+            top = 0;
+            Array<int> empty_B;
+            Array<int> empty_stack;
+            B.swap(empty_B);
+            index_stack.swap(empty_stack);
+        }
+
+        // Moves the cells into a new array of new_size >= size() cells, in a single pass over the initialized ones.
+        // If every cell is initialized, they all become dense, and the new B and index_stack only cover the new cells.
+        void reallocate(int new_size)
+        {
+            assert(new_size >= max_size);
+            finishMigration();
+            int new_dense = (num_initialized == max_size)? max_size : dense;
+            Cells new_values(new_size);
+            Array<int> new_B(new_size - new_dense);
+            Array<int> new_stack(new_size - new_dense);
+            for(int i = 0; i < dense; i++)
+            {
+                moveCell(values[i], new_values[i]);
+            }
+            for(int j = 0; j < top; j++)
+            {
+                int i = index_stack[j];
+                moveCell(values[i], new_values[i]);
+                if(new_dense == dense)
+                {
+                    new_stack[j] = i;
+                    new_B[i - dense] = j;
+                }
+            }
+            values.swap(new_values);
+            B.swap(new_B);
+            index_stack.swap(new_stack);
+            if(new_dense != dense)
+            {
+                top = 0;
+            }
+            dense = new_dense;
+            max_size = new_size;
+        }
         
 
     public:
@@ -40,34 +235,76 @@ namespace DS
          *        DynamicArray<T> new_array(size);
          * -----------------------------------
          * Initializes a new empty Array that stores objects of type <T>.
-         * Creates and allocates an array with size elements.
+         * Creates and allocates an array with size elements, none of which is constructed yet.
          * Creating a dynamic array without stating the default val will default
          * it to the default constructor value of VAL_TYPE.
          * The max size of the elements in the array is dynamic and will be
          * reallocated automatically when the array fills up.
          * DO NOT INITIALIZE TO SIZE 0.
-         * REALLOC_FACTOR HAS TO BE >= 1!
+         * REALLOC_FACTOR HAS TO BE >= 1! (and >= 2 for INCREMENTAL_GROWTH to keep every operation O(1))
          * 
          * Possible exceptions:
          * std::bad_alloc
          */
         explicit DynamicArray(int max_size, VAL_TYPE default_val = VAL_TYPE(), int re_fact = 1) : 
-        values(Array<VAL_TYPE>(max_size)), B(Array<int>(max_size)), index_stack(Array<int>(max_size)),
-        top(0), num_initialized(0), max_size(max_size), default_val(default_val), realloc_factor(re_fact) { }
+        values(max_size), old_values(), migrated(0), B(Array<int>(max_size)), index_stack(Array<int>(max_size)),
+        dense(0), top(0), num_initialized(0), max_size(max_size), default_val(default_val), realloc_factor(re_fact) { }
         /*
          * Copy Constructor: DynamicArray<T>
          * Usage: DynamicArray<T> new_array = arr;
          * -----------------------------------
          * Creates a new array that is a copy of other.
+         * Only the initialized cells are copied, and an incremental growth of other is finished in the copy.
          * 
          * Possible exceptions:
-         * No assignment operator to class T, std::bad_aloc
+         * No copy constructor to class T, std::bad_aloc
          */
         DynamicArray(const DynamicArray& other) :
-        values(other.values), B(other.B), index_stack(other.index_stack), top(other.top), num_initialized(other.num_initialized),
-        max_size(other.max_size), default_val(other.default_val), realloc_factor(other.realloc_factor) { }
+        values(other.max_size), old_values(), migrated(0), B(other.B), index_stack(other.index_stack), dense(other.dense), top(other.top), num_initialized(0),
+        max_size(other.max_size), default_val(other.default_val), realloc_factor(other.realloc_factor)
+        {
+            // num_initialized counts the copied cells, so if a copy throws, the ones before it are destroyed:
+            try
+            {
+                other.forInitialized([this, &other](int i)
+                {
+                    new (&values[i]) VAL_TYPE(other.cell(i));
+                    num_initialized++;
+                });
+            }
+            catch(...)
+            {
+                for(int i = 0; i < dense && num_initialized > 0; i++, num_initialized--)
+                {
+                    values[i].~VAL_TYPE();
+                }
+                for(int j = 0; num_initialized > 0; j++, num_initialized--)
+                {
+                    values[index_stack[j]].~VAL_TYPE();
+                }
+                throw;
+            }
+        }
+
+        /*
+         * Move Constructor: DynamicArray<T>
+         * Usage: DynamicArray<T> new_array = std::move(arr);
+         * -----------------------------------
+         * Creates a new array that takes over the cells of other without copying them.
+         * other is left without cells, and may only be assigned to or destroyed.
+         */
+        DynamicArray(DynamicArray&& other) :
+        values(std::move(other.values)), old_values(std::move(other.old_values)), migrated(other.migrated), B(std::move(other.B)), index_stack(std::move(other.index_stack)), dense(other.dense),
+        top(other.top), num_initialized(other.num_initialized), max_size(other.max_size), default_val(std::move(other.default_val)),
+        realloc_factor(other.realloc_factor)
+        {
+            other.migrated = other.dense = other.top = other.num_initialized = other.max_size = 0;
+        }
 
-        virtual ~DynamicArray() = default;
+        virtual ~DynamicArray()
+        {
+            forInitialized([this](int i) { cell(i).~VAL_TYPE(); });
+        }
         /*
          * Operator: =
          * Usage: this_array = target_arr;
@@ -76,15 +313,74 @@ namespace DS
          * to target_arr's elements.
          * 
          * Possible exceptions:
-         * No assignment operator to class T, std::bad_aloc
+         * No copy constructor to class T, std::bad_aloc
          */
-        DynamicArray& operator=(const DynamicArray& target_arr) = default;
+        DynamicArray& operator=(const DynamicArray& target_arr)
+        {
+            if(this != &target_arr)
+            {
+                DynamicArray copy(target_arr);
+                swap(copy);
+            }
+            return *this;
+        }
+
+        DynamicArray& operator=(DynamicArray&& target_arr)
+        {
+            if(this != &target_arr)
+            {
+                DynamicArray moved(std::move(target_arr));
+                swap(moved);
+            }
+            return *this;
+        }
 
         // Return a bool value to determine whether the dynamic array at index i is initialized.
         bool isInitialized(int i) const noexcept
         {
             assert(i >= 0);
-            return ((i < max_size) && (B[i] < top) && (B[i] >= 0) && (index_stack[B[i]] == i));
+            if(i < dense)
+            {
+                return true;
+            }
+            return ((i < max_size) && (B[i - dense] < top) && (B[i - dense] >= 0) && (index_stack[B[i - dense]] == i));
+        }
+
+        /*
+         * Method: prefetch
+         * Usage: array.prefetch(i);
+         *        array.prefetchInitialized(i);
+         * -----------------------------------
+         * Hints the processor to start loading what isInitialized(i) and get(i) read into the cache,
+         * so that many cells can be waited for at once. prefetch loads the cell i and its B entry.
+         * prefetchInitialized loads the index_stack entry that B[i] points to, so it should be called
+         * a while after prefetch(i). Both do nothing if i is out of range.
+         * 
+         * Possible exceptions:
+         * No exception.
+         */
+        void prefetch(int i) const noexcept
+        {
+#ifdef __GNUC__
+            if(i < max_size)
+            {
+                if(i >= dense)
+                {
+                    __builtin_prefetch(&B[i - dense]);
+                }
+                __builtin_prefetch(&cell(i));
+            }
+#endif
+        }
+
+        void prefetchInitialized(int i) const noexcept
+        {
+#ifdef __GNUC__
+            if(i >= dense && i < max_size && B[i - dense] >= 0 && B[i - dense] < top)
+            {
+                __builtin_prefetch(&index_stack[B[i - dense]]);
+            }
+#endif
         }
 
         /*
@@ -94,6 +390,8 @@ namespace DS
          * Returns the element in the cell i of the array.
          * Can only access elements in range of size(), otherwise
          * throws an exception.
+         * During an incremental growth the non const get also moves a few cells,
+         * so the references it gives are only valid until the next store or get.
          * 
          * Possible exceptions:
          * OutOfBounds
@@ -106,7 +404,7 @@ namespace DS
             }
             if(isInitialized(i))
             {
-                return values[i];
+                return cell(i);
             }
             return default_val;
         }
@@ -117,9 +415,10 @@ namespace DS
             {
                 throw OutOfBounds();
             }
+            migrate(MIGRATE_STEP);
             if(isInitialized(i))
             {
-                return values[i];
+                return cell(i);
             }
             return default_val;
         }
@@ -133,6 +432,10 @@ namespace DS
          * throws and exception.
          * Will only be able to exceed the bounds of the array once all
          * of the cells have been initialized.
+         * Once all of the cells have been initialized, the array stops keeping track of
+         * which are, and a growing array moves them into one realloc_factor times as large.
+         * With INCREMENTAL_GROWTH the move is spread over the following stores and gets,
+         * so the worst time of every store is O(1) (besides allocating the larger array).
          * 
          * Possible exceptions:
          * OutOfBounds, std::bad_alloc
@@ -143,22 +446,58 @@ namespace DS
             {
                 throw OutOfBounds();
             }
+            migrate(MIGRATE_STEP);
             if(!isInitialized(i))
             {
+                new (&cell(i)) VAL_TYPE(std::move(val));
                 index_stack[top] = i;
-                B[i] = top;
+                B[i - dense] = top;
                 top++;
                 num_initialized++;
             }
-            values[i] = val;
+            else
+            {
+                cell(i) = std::move(val);
+            }
             
             // Check to see if the array is now full:
-            if(realloc_factor > 1 && num_initialized >= max_size)
+            if(num_initialized >= max_size)
             {
-                expandArray();
+                if(realloc_factor > 1)
+                {
+                    expandArray();
+                }
+                else if(dense < max_size)
+                {
+                    dropInitData();
+                }
             }
         }
 
+        /*
+         * Method: swap
+         * Usage: array.swap(other);
+         * -----------------------------------
+         * Swaps the contents of the two arrays, without copying them.
+         * 
+         * Possible exceptions:
+         * No exception.
+         */
+        void swap(DynamicArray& other)
+        {
+            values.swap(other.values);
+            old_values.swap(other.old_values);
+            std::swap(migrated, other.migrated);
+            B.swap(other.B);
+            index_stack.swap(other.index_stack);
+            std::swap(dense, other.dense);
+            std::swap(top, other.top);
+            std::swap(num_initialized, other.num_initialized);
+            std::swap(max_size, other.max_size);
+            std::swap(default_val, other.default_val);
+            std::swap(realloc_factor, other.realloc_factor);
+        }
+
         /*
          * Method: size
          * Usage: array.size();
@@ -188,19 +527,98 @@ namespace DS
             return num_initialized;
         }
 
+        /*
+         * Method: reserve
+         * Usage: array.reserve(count);
+         * -----------------------------------
+         * Makes room for count cells, so that storing into the cells [0, count) never reallocates the array.
+         * (An array with a realloc factor grows as soon as it is full, so it gets one cell more)
+         * Does nothing if the array is already large enough.
+         * Worst time complexity: O(count)
+         * 
+         * Possible exceptions:
+         * std::bad_alloc
+         */
+        void reserve(int count)
+        {
+            if(realloc_factor > 1 && count == INT_MAX)
+            {
+                throw std::bad_alloc();
+            }
+            int needed = realloc_factor > 1? count + 1 : count;
+            if(needed > max_size)
+            {
+                reallocate(needed);
+            }
+        }
+
+        /*
+         * Method: truncate
+         * Usage: array.truncate(new_size);
+         * -----------------------------------
+         * Destroys the cells from new_size on and makes the array new_size cells long, keeping its memory.
+         * Dropping the last cell of an array is O(1), so a large array can be taken apart
+         * a few cells at a time, and destroying what is left of it costs nothing once it is empty.
+         * An incremental growth in progress is finished first.
+         * Worst time complexity: O(size() - new_size)
+         * 
+         * Possible exceptions:
+         * No exception.
+         */
+        void truncate(int new_size)
+        {
+            assert(new_size >= 0 && new_size <= max_size);
+            finishMigration();
+            for(int i = max_size - 1; i >= new_size; i--)
+            {
+                if(i < dense) // Every cell above i is gone, so none is tracked by B and index_stack
+                {
+                    assert(top == 0);
+                    values[i].~VAL_TYPE();
+                    dense = i;
+                    num_initialized--;
+                }
+                else if(isInitialized(i)) // The last entry of index_stack takes the place of the entry of i
+                {
+                    values[i].~VAL_TYPE();
+                    int entry = B[i - dense];
+                    int last = index_stack[--top];
+                    index_stack[entry] = last;
+                    B[last - dense] = entry;
+                    num_initialized--;
+                }
+            }
+            values.shrink(new_size);
+            max_size = new_size;
+        }
+
+        /*
+         * Method: expandArray
+         * Usage: array.expandArray();
+         *        array.expandArray(factor);
+         * -----------------------------------
+         * Moves the cells into an array factor times as large. (realloc_factor times if no factor is given)
+         * Only the initialized cells are moved, each once, so the time is about that of moving their bytes.
+         * With INCREMENTAL_GROWTH, a full array only allocates the larger array here. (see store)
+         * Worst time complexity: O(size() * factor)
+         * 
+         * Possible exceptions:
+         * std::bad_alloc
+         */
         void expandArray(int factor = -1)
         {
             if (factor == -1)
             {
                 factor = realloc_factor;
             }
-            int new_size = max_size*factor;
-            DynamicArray<VAL_TYPE> new_array(new_size, VAL_TYPE(), realloc_factor);
-            for(int i = 0; i < max_size; i++)
+            if(INCREMENTAL_GROWTH && num_initialized == max_size)
+            {
+                startGrowth(max_size*factor);
+            }
+            else
             {
-                new_array.store(i, get(i));
+                reallocate(max_size*factor);
             }
-            *this = new_array;
         }
     };
 }
@@ -13,6 +13,7 @@ namespace DS
     };
     class OutOfBounds : public Exceptions { };
     class KeyNotFound : public Exceptions { };
+    class KeyAlreadyExists : public Exceptions { };
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,585 @@
+#ifndef _FLAT_TABLE_H
+#define _FLAT_TABLE_H
+#include <stdint.h>
+#include <new>
+#include <utility>
+#include <cstring>
+#include "../Exceptions/Exceptions.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace DS
+{
+    /*
+     * Class: FlatTable
+     * ---------------------------------------
+     * An open addressing hash table, in the style of a Swiss table.
+     * The pairs are stored flat in one array of slots, next to an array of one control byte per slot.
+     * A control byte is EMPTY, DELETED, or 7 bits of the hash of the key in the slot.
+     * The slots are probed in groups of 16: the control bytes of a whole group are compared to the
+     * hash bits at once (with SSE2), and only the slots that match are compared to the key.
+     * Has the insert/erase/get/find/size interface of ChainTable.
+     */
+    template<typename VAL_TYPE>
+    class FlatTable
+    {
+    private:
+        /*********************************/
+        /*        Private Section        */
+        /*********************************/
+        struct Slot
+        {
+            int key;
+            VAL_TYPE val;
+
+            template<class... ARGS>
+            Slot(int key, ARGS&&... args) : key(key), val(std::forward<ARGS>(args)...) { }
+            Slot(Slot&& other) : key(other.key), val(std::move(other.val)) { }
+        };
+
+        int8_t* ctrl;
+        Slot* slots;
+        int capacity; // A power of 2, and a multiple of GROUP_SIZE
+        int elem_counter;
+        int deleted_counter;
+
+        /*   Private Static Variables   */
+        static const int GROUP_SIZE = 16;
+        static const int INIT_SIZE = 16; // Initial table size
+        static const int MAX_CAPACITY = 1 << 30; // The largest power of 2 an int can hold
+        static const int8_t EMPTY = -128;
+        static const int8_t DELETED = -2;
+
+        /*   Private Methods/Static Functions   */
+        // Mixes the key into 64 bits. The low 7 bits go to the control byte, and the rest pick the first group.
+        static uint64_t hash(int key)
+        {
+            uint64_t hashed = uint64_t(uint32_t(key)) * 0x9E3779B97F4A7C15ull;
+            return hashed ^ (hashed >> 32);
+        }
+
+        // Returns a bit mask of the control bytes in the group that are equal to byte.
+        static unsigned matchByte(const int8_t* group, int8_t byte)
+        {
+#ifdef __SSE2__
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+            return unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(byte))));
+#else
+            unsigned mask = 0;
+            for(int i = 0; i < GROUP_SIZE; i++)
+            {
+                mask |= unsigned(group[i] == byte) << i;
+            }
+            return mask;
+#endif
+        }
+
+        // Returns a bit mask of the EMPTY and DELETED control bytes in the group.
+        static unsigned matchFree(const int8_t* group)
+        {
+#ifdef __SSE2__
+            // EMPTY and DELETED are the only negative control bytes:
+            return unsigned(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+            unsigned mask = 0;
+            for(int i = 0; i < GROUP_SIZE; i++)
+            {
+                mask |= unsigned(group[i] < 0) << i;
+            }
+            return mask;
+#endif
+        }
+
+        static int lowestBit(unsigned mask)
+        {
+#ifdef __GNUC__
+            return __builtin_ctz(mask);
+#else
+            int i = 0;
+            while(!(mask & (1u << i)))
+            {
+                i++;
+            }
+            return i;
+#endif
+        }
+
+        // Returns the slot of key, or -1 if it is not in the table.
+        int findSlot(int key) const
+        {
+            uint64_t hashed = hash(key);
+            int8_t hash_bits = int8_t(hashed & 0x7F);
+            int group_mask = capacity/GROUP_SIZE - 1;
+            int group = int(hashed >> 7) & group_mask;
+            // Triangular probing over the groups visits all of them, since their number is a power of 2.
+            for(int step = 1; ; step++)
+            {
+                const int8_t* group_ctrl = ctrl + group*GROUP_SIZE;
+                for(unsigned mask = matchByte(group_ctrl, hash_bits); mask; mask &= mask - 1)
+                {
+                    int slot = group*GROUP_SIZE + lowestBit(mask);
+                    if(slots[slot].key == key)
+                    {
+                        return slot;
+                    }
+                }
+                if(matchByte(group_ctrl, EMPTY)) // A probe for key would have stopped here
+                {
+                    return -1;
+                }
+                group = (group + step) & group_mask;
+            }
+        }
+
+        // Returns the first EMPTY or DELETED slot on the probe sequence of hashed.
+        static int findFree(const int8_t* ctrl, int capacity, uint64_t hashed)
+        {
+            int group_mask = capacity/GROUP_SIZE - 1;
+            int group = int(hashed >> 7) & group_mask;
+            for(int step = 1; ; step++)
+            {
+                unsigned mask = matchFree(ctrl + group*GROUP_SIZE);
+                if(mask)
+                {
+                    return group*GROUP_SIZE + lowestBit(mask);
+                }
+                group = (group + step) & group_mask;
+            }
+        }
+
+        static Slot* allocateSlots(int capacity)
+        {
+            return static_cast<Slot*>(::operator new(sizeof(Slot) * capacity));
+        }
+
+        static int8_t* allocateCtrl(int capacity)
+        {
+            int8_t* new_ctrl = new int8_t[capacity];
+            memset(new_ctrl, EMPTY, capacity);
+            return new_ctrl;
+        }
+
+        // Throws std::bad_alloc if num_elements do not fit in MAX_CAPACITY slots.
+        static int tableSizeFor(int num_elements)
+        {
+            if(num_elements > MAX_CAPACITY - MAX_CAPACITY/8)
+            {
+                throw std::bad_alloc();
+            }
+            int size = INIT_SIZE;
+            while(size - size/8 < num_elements)
+            {
+                size *= 2;
+            }
+            return size;
+        }
+
+        // Moves every pair into a new table of new_capacity slots, which also clears the DELETED slots.
+        void rehash(int new_capacity)
+        {
+            int8_t* new_ctrl = allocateCtrl(new_capacity);
+            Slot* new_slots;
+            try
+            {
+                new_slots = allocateSlots(new_capacity);
+            }
+            catch(const std::bad_alloc& e)
+            {
+                delete[] new_ctrl;
+                throw;
+            }
+            for(int i = 0; i < capacity; i++)
+            {
+                if(ctrl[i] >= 0)
+                {
+                    uint64_t hashed = hash(slots[i].key);
+                    int slot = findFree(new_ctrl, new_capacity, hashed);
+                    new (&new_slots[slot]) Slot(std::move(slots[i]));
+                    new_ctrl[slot] = int8_t(hashed & 0x7F);
+                    slots[i].~Slot();
+                }
+            }
+            delete[] ctrl;
+            ::operator delete(slots);
+            ctrl = new_ctrl;
+            slots = new_slots;
+            capacity = new_capacity;
+            deleted_counter = 0;
+        }
+
+        // Returns the free slot for key, which is known not to be in the table, and grows the table first if needed.
+        // Throws std::bad_alloc if the table is full and already has MAX_CAPACITY slots.
+        int prepareInsert(int key)
+        {
+            if(elem_counter + deleted_counter >= capacity - capacity/8)
+            {
+                // Only grow if most of the used slots hold pairs, otherwise clearing the DELETED ones is enough:
+                bool grow = elem_counter >= capacity/2;
+                if(grow && capacity >= MAX_CAPACITY)
+                {
+                    if(elem_counter >= capacity - capacity/8)
+                    {
+                        throw std::bad_alloc();
+                    }
+                    grow = false;
+                }
+                rehash(grow? capacity*2 : capacity);
+            }
+            return findFree(ctrl, capacity, hash(key));
+        }
+
+        // Marks the slot, after a pair was constructed in it.
+        void commitInsert(int slot, int key)
+        {
+            if(ctrl[slot] == DELETED)
+            {
+                deleted_counter--;
+            }
+            ctrl[slot] = int8_t(hash(key) & 0x7F);
+            elem_counter++;
+        }
+
+        // Destroys the pair in slot and marks the slot free.
+        void eraseSlot(int slot)
+        {
+            slots[slot].~Slot();
+            // A probe never went past a group with an EMPTY slot, so the slot can be EMPTY again:
+            if(matchByte(ctrl + (slot & ~(GROUP_SIZE - 1)), EMPTY))
+            {
+                ctrl[slot] = EMPTY;
+            }
+            else
+            {
+                ctrl[slot] = DELETED;
+                deleted_counter++;
+            }
+            elem_counter--;
+        }
+
+        // Inserts the pair (key, value) into the table, copying or moving value in. (if VAL is not a reference)
+        template<class VAL>
+        void insertAux(int key, VAL&& value)
+        {
+            int slot = findSlot(key);
+            if(slot >= 0)
+            {
+                slots[slot].val = std::forward<VAL>(value);
+                return;
+            }
+            slot = prepareInsert(key);
+            new (&slots[slot]) Slot(key, std::forward<VAL>(value));
+            commitInsert(slot, key);
+        }
+
+        // Returns the value of key, and inserts the value make() for it first if key is not in the table.
+        // *inserted is set to whether it was inserted.
+        template<class FACTORY>
+        VAL_TYPE& findOrInsertAux(int key, FACTORY& make, bool* inserted)
+        {
+            int slot = findSlot(key);
+            *inserted = slot < 0;
+            if(slot < 0)
+            {
+                slot = prepareInsert(key);
+                new (&slots[slot]) Slot(key, make());
+                commitInsert(slot, key);
+            }
+            return slots[slot].val;
+        }
+
+        void destroySlots()
+        {
+            for(int i = 0; i < capacity; i++)
+            {
+                if(ctrl[i] >= 0)
+                {
+                    slots[i].~Slot();
+                }
+            }
+        }
+
+    public:
+        /**********************************/
+        /*         Public Section         */
+        /**********************************/
+        /*
+         * Constructor: FlatTable
+         * Usage: FlatTable<VAL_TYPE> table;
+         *        FlatTable<VAL_TYPE> table(init_size);
+         * ---------------------------------------
+         * Creates an empty hash table with room for init_size elements before it grows.
+         * If no init_size is inserted, assumes the INIT_SIZE slots. (static var)
+         * Worst time complexity: O(init_size)
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        FlatTable() : FlatTable(0) { }
+
+        FlatTable(int init_size) : ctrl(nullptr), slots(nullptr), capacity(tableSizeFor(init_size)), elem_counter(0), deleted_counter(0)
+        {
+            ctrl = allocateCtrl(capacity);
+            try
+            {
+                slots = allocateSlots(capacity);
+            }
+            catch(const std::bad_alloc& e)
+            {
+                delete[] ctrl;
+                throw;
+            }
+        }
+
+        FlatTable(const FlatTable<VAL_TYPE>& other) : FlatTable(0)
+        {
+            if(other.capacity != capacity)
+            {
+                rehash(other.capacity);
+            }
+            for(int i = 0; i < other.capacity; i++)
+            {
+                if(other.ctrl[i] >= 0)
+                {
+                    new (&slots[i]) Slot(other.slots[i].key, other.slots[i].val);
+                    ctrl[i] = other.ctrl[i];
+                    elem_counter++;
+                }
+                else
+                {
+                    ctrl[i] = other.ctrl[i];
+                }
+            }
+            deleted_counter = other.deleted_counter;
+        }
+
+        ~FlatTable()
+        {
+            destroySlots();
+            delete[] ctrl;
+            ::operator delete(slots);
+        }
+
+        FlatTable<VAL_TYPE>& operator=(const FlatTable<VAL_TYPE>& other)
+        {
+            if(this == &other)
+            {
+                return *this;
+            }
+            FlatTable<VAL_TYPE> copy(other);
+            std::swap(ctrl, copy.ctrl);
+            std::swap(slots, copy.slots);
+            std::swap(capacity, copy.capacity);
+            std::swap(elem_counter, copy.elem_counter);
+            std::swap(deleted_counter, copy.deleted_counter);
+            return *this;
+        }
+
+        /*
+         * Method: insert
+         * Usage: table.insert(key, value);
+         * ---------------------------------------
+         * Inserts the pair (key, value) into the table, or replaces the value of key if it is already there.
+         * An rvalue value is moved into its slot rather than copied.
+         * The table grows (twice as big) once 7/8 of its slots are full or DELETED.
+         * Average time complexity: O(1)
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        void insert(int key, const VAL_TYPE& value)
+        {
+            insertAux(key, value);
+        }
+
+        void insert(int key, VAL_TYPE&& value)
+        {
+            insertAux(key, std::move(value));
+        }
+
+        /*
+         * Method: reserve
+         * Usage: table.reserve(count);
+         * ---------------------------------------
+         * Makes room for count pairs, so inserting up to count pairs into the table does not grow it.
+         * Worst time complexity: O(capacity + count)
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        void reserve(int count)
+        {
+            int new_capacity = tableSizeFor(count);
+            if(new_capacity > capacity)
+            {
+                rehash(new_capacity);
+            }
+        }
+
+        /*
+         * Method: findOrInsert
+         * Usage: table.findOrInsert(key, factory);
+         * ---------------------------------------
+         * Returns the value matching key in the table. If key is not in the table,
+         * inserts it first with the value factory() returns.
+         * The key is hashed and searched once.
+         * The reference is valid until the next insertion or removal.
+         * Average time complexity: O(1)
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        template<class FACTORY>
+        VAL_TYPE& findOrInsert(int key, FACTORY factory)
+        {
+            bool inserted;
+            return findOrInsertAux(key, factory, &inserted);
+        }
+
+        /*
+         * Method: emplace
+         * Usage: table.emplace(key, args...);
+         * ---------------------------------------
+         * Inserts key with the value VAL_TYPE(args...), constructed in its slot, if key is not in the table.
+         * Returns true if it was inserted, or false if key was already in the table. (and its value is kept)
+         * The key is hashed and searched once.
+         * Average time complexity: O(1)
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        template<class... ARGS>
+        bool emplace(int key, ARGS&&... args)
+        {
+            if(findSlot(key) >= 0)
+            {
+                return false;
+            }
+            int slot = prepareInsert(key);
+            new (&slots[slot]) Slot(key, std::forward<ARGS>(args)...);
+            commitInsert(slot, key);
+            return true;
+        }
+
+        /*
+         * Method: erase
+         * Usage: table.erase(key);
+         * ---------------------------------------
+         * Removes key and its contents from the table.
+         * Average time complexity: O(1)
+         */
+        void erase(int key)
+        {
+            int slot = findSlot(key);
+            if(slot >= 0)
+            {
+                eraseSlot(slot);
+            }
+        }
+
+        /*
+         * Method: extract
+         * Usage: table.extract(key, sink);
+         * ---------------------------------------
+         * Removes key from the table like erase, but first calls sink(value) on the value matching it.
+         * Returns true if key was in the table, or false (and sink is not called) otherwise.
+         * The key is hashed and searched once.
+         * Average time complexity: O(1 + O(sink))
+         */
+        template<class SINK>
+        bool extract(int key, SINK sink)
+        {
+            int slot = findSlot(key);
+            if(slot < 0)
+            {
+                return false;
+            }
+            sink(slots[slot].val);
+            eraseSlot(slot);
+            return true;
+        }
+
+        /*
+         * Method: get
+         * Usage: table.get(key);
+         * ---------------------------------------
+         * Returns the value matching key in the table.
+         * Average time complexity: O(1)
+         *
+         * Possible Exceptions:
+         * KeyNotFound
+         */
+        const VAL_TYPE& get(int key) const
+        {
+            int slot = findSlot(key);
+            if(slot < 0)
+            {
+                throw KeyNotFound();
+            }
+            return slots[slot].val;
+        }
+
+        VAL_TYPE& get(int key)
+        {
+            int slot = findSlot(key);
+            if(slot < 0)
+            {
+                throw KeyNotFound();
+            }
+            return slots[slot].val;
+        }
+
+        /*
+         * Method: tryGet
+         * Usage: table.tryGet(key);
+         * ---------------------------------------
+         * Returns a pointer to the value matching key in the table, or a null pointer if key is not in the table.
+         * The pointer is valid until the next insertion or removal.
+         * Average time complexity: O(1)
+         */
+        const VAL_TYPE* tryGet(int key) const
+        {
+            int slot = findSlot(key);
+            return slot < 0? nullptr : &slots[slot].val;
+        }
+
+        VAL_TYPE* tryGet(int key)
+        {
+            int slot = findSlot(key);
+            return slot < 0? nullptr : &slots[slot].val;
+        }
+
+        /*
+         * Method: find
+         * Usage: table.find(key);
+         * ---------------------------------------
+         * Returns a bool value indicating if key is in the table.
+         * Average time complexity: O(1)
+         */
+        bool find(int key) const
+        {
+            return findSlot(key) >= 0;
+        }
+
+        /*
+         * Method: size
+         * Usage: table.size();
+         * -----------------------------------
+         * Returns the current number of elements in the table.
+         *
+         * Possible exceptions:
+         * No exception.
+         */
+        int size() const
+        {
+            return elem_counter;
+        }
+
+        int tableSize() const
+        {
+            return capacity;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,342 @@
+#ifndef _LECTURE_RANKING_H
+#define _LECTURE_RANKING_H
+#include <stdint.h>
+#include "RankAVL/RankAVL.h"
+#include "RankBTree/RankBTree.h"
+#include "DynamicArray/Array.h"
+
+namespace DS
+{
+    /*
+     * Struct: LectureContainer
+     * ---------------------------------------
+     * A class and its views, packed into one ordering key: views ascending, then course descending,
+     * then lecture descending. The views sit above the complemented course id in the high word, and
+     * the complemented lecture id is the low word, so comparing two classes takes two integer compares
+     * and no branches.
+     */
+    struct LectureContainer
+    {
+        uint64_t high; // views << 32 | ~course
+        uint64_t low;  // ~lecture
+
+        LectureContainer() = default;
+
+        LectureContainer(int views, int course, int lecture) :
+        high(uint64_t(uint32_t(views)) << 32 | uint32_t(~course)), low(uint32_t(~lecture)) { }
+
+        int views() const
+        {
+            return int(high >> 32);
+        }
+
+        int course() const
+        {
+            return ~int(uint32_t(high));
+        }
+
+        int lecture() const
+        {
+            return ~int(uint32_t(low));
+        }
+
+        void addViews(int time)
+        {
+            high += uint64_t(uint32_t(time)) << 32;
+        }
+
+        bool operator<(const LectureContainer& other) const
+        {
+            return (high < other.high) | ((high == other.high) & (low < other.low));
+        }
+
+        bool operator==(const LectureContainer& other) const
+        {
+            return ((high ^ other.high) | (low ^ other.low)) == 0;
+        }
+
+        bool operator!=(const LectureContainer& other) const
+        {
+            return !(*this == other);
+        }
+
+        bool operator<=(const LectureContainer& other) const
+        {
+            return !(other < *this);
+        }
+
+        bool operator>(const LectureContainer& other) const
+        {
+            return other < *this;
+        }
+
+        bool operator>=(const LectureContainer& other) const
+        {
+            return !(*this < other);
+        }
+    };
+
+    /*
+     * Lecture rankings
+     * ---------------------------------------
+     * A ranking keeps the watched classes ordered by LectureContainer, and answers the ranking queries of Boom2,
+     * where rank 1 is the class with the highest key (the most views). Every ranking exposes:
+     *   handle                                  - What a class keeps to find its key in the ranking.
+     *   insert(lecture)                         - Adds a class, and returns its handle.
+     *   update(node, old_lecture, lecture)      - Moves a class to its new key.
+     *   erase(node, lecture)                    - Removes a class.
+     *   size()                                  - The number of classes in the ranking.
+     *   reserve(count)                          - Prepares room for count more classes.
+     *   ith(i)                                  - The class ranked i.
+     *   range(from, to, course_ids, class_ids)  - Writes the classes ranked from..to.
+     *   batch(ranks, count, course_ids, class_ids) - Writes the classes of ascending ranks.
+     *   rankOf(lecture)                         - The rank of a class in the ranking.
+     */
+
+    // Keeps the ranking in a rank tree, with a node pool (see RankAVL/NodeStorage.h).
+    class AVLRanking
+    {
+        class SubtreeSize
+        {
+        public:
+            template<class NODE>
+            void operator()(NODE& node, const NODE* left, const NODE* right)
+            {
+                int left_size = left? left->val : 0;
+                int right_size = right? right->val : 0;
+                node.val = left_size + right_size + 1;
+            }
+
+            // Returns the size of the sub tree of node.
+            template<class NODE>
+            int operator()(const NODE& node) const
+            {
+                return node.val;
+            }
+        };
+
+        typedef RankAVL<SubtreeSize, LectureContainer, int, NodePool<LectureContainer, int>> LectureTree;
+        typedef LectureTree::NODE LectureNode;
+
+        // Directs a rank search to the class with the i-th most views.
+        class FindIthWatchedClass
+        {
+            int i;
+        public:
+            FindIthWatchedClass(int i) : i(i) { }
+
+            SearchPath operator()(const LectureNode& node, const LectureNode* left, const LectureNode* right)
+            {
+                SearchPath result = SearchPath::end;
+                int right_rank = right? right->val : 0;
+                if(right_rank == i - 1) // The current node is the wanted node.
+                {
+                    return result;
+                }
+                else if(right_rank > i - 1) // The node we are looking for is in the right sub-tree.
+                {
+                    result = SearchPath::right;
+                }
+                else // right_rank < i - 1: The node we are looking for is in the left sub-tree.
+                {
+                    result = SearchPath::left;
+                    i = i - right_rank - 1;
+                }
+                
+                return result;
+            }
+        };
+
+        // Directs a rank search to the node of key, and counts the classes with more views on the way.
+        class CountGreaterClasses
+        {
+            LectureContainer key;
+            int* greater;
+        public:
+            CountGreaterClasses(const LectureContainer& key, int* greater) : key(key), greater(greater)
+            {
+                *greater = 0;
+            }
+
+            SearchPath operator()(const LectureNode& node, const LectureNode* left, const LectureNode* right)
+            {
+                int right_rank = right? right->val : 0;
+                if(node.key < key) // The whole left sub-tree and the node are below key.
+                {
+                    return SearchPath::right;
+                }
+                *greater += right_rank; // The whole right sub-tree is above key.
+                if(node.key == key)
+                {
+                    return SearchPath::end;
+                }
+                *greater += 1; // The node itself is above key.
+                return SearchPath::left;
+            }
+        };
+
+        LectureTree lecture_tree;
+
+    public:
+        // The class keeps its tree node, which is moved to the place of a new key.
+        typedef LectureTree::link handle;
+
+        AVLRanking() : lecture_tree(SubtreeSize()) { }
+
+        handle insert(const LectureContainer& lecture)
+        {
+            return lecture_tree.insert(lecture, 0);
+        }
+
+        void update(handle& node, const LectureContainer& old_lecture, const LectureContainer& lecture)
+        {
+            lecture_tree.updateKey(node, lecture);
+        }
+
+        void erase(handle node, const LectureContainer& lecture)
+        {
+            lecture_tree.eraseNode(node);
+        }
+
+        int size() const
+        {
+            return lecture_tree.size();
+        }
+
+        void reserve(int count)
+        {
+            lecture_tree.reserve(count);
+        }
+
+        const LectureContainer& ith(int i) const
+        {
+            return lecture_tree.rank(FindIthWatchedClass(i))->key;
+        }
+
+        // The class ranked from is found with one descent, and the rest are read by walking down the ranking.
+        void range(int from, int to, int* course_ids, int* class_ids) const
+        {
+            LectureTree::const_iterator current = lecture_tree.rankIterator(FindIthWatchedClass(from));
+            for(int k = 0; k <= to - from; k++, --current) // The ranking goes from the highest key down
+            {
+                course_ids[k] = current->key.course();
+                class_ids[k] = current->key.lecture();
+            }
+        }
+
+        // The ranks are turned into in-order positions (which come in the opposite order),
+        // and all of the classes are found in one traversal of the lecture tree.
+        void batch(const int* ranks, int count, int* course_ids, int* class_ids) const
+        {
+            int num_of_lectures = lecture_tree.size();
+            Array<int> positions(count);
+            Array<const LectureNode*> targets(count);
+            for(int i = 0; i < count; i++)
+            {
+                positions[i] = num_of_lectures - ranks[count - 1 - i] + 1;
+            }
+            lecture_tree.selectBatch(SubtreeSize(), &positions[0], count, &targets[0]);
+            for(int i = 0; i < count; i++)
+            {
+                const LectureNode* target = targets[count - 1 - i];
+                course_ids[i] = target->key.course();
+                class_ids[i] = target->key.lecture();
+            }
+        }
+
+        // The rank is one more than the number of classes above the class in the ranking.
+        int rankOf(const LectureContainer& lecture) const
+        {
+            int greater;
+            lecture_tree.rank(CountGreaterClasses(lecture, &greater));
+            return greater + 1;
+        }
+    };
+
+    // Keeps the ranking in an order statistics B+ tree (see RankBTree/RankBTree.h).
+    // The keys move inside the leaves, so a class has no handle, and is found by its key.
+    class BTreeRanking
+    {
+        typedef RankBTree<LectureContainer> LectureTree;
+
+        LectureTree lecture_tree;
+
+        static const int MAX_WALK = 64; // The farthest batch walks to the next rank instead of descending again
+
+        // Returns the iterator of the class ranked i.
+        LectureTree::const_iterator find(int i) const
+        {
+            return lecture_tree.select(lecture_tree.size() - i + 1);
+        }
+
+    public:
+        typedef int handle;
+
+        handle insert(const LectureContainer& lecture)
+        {
+            lecture_tree.insert(lecture);
+            return 0;
+        }
+
+        void update(handle& node, const LectureContainer& old_lecture, const LectureContainer& lecture)
+        {
+            lecture_tree.erase(old_lecture);
+            lecture_tree.insert(lecture);
+        }
+
+        void erase(handle node, const LectureContainer& lecture)
+        {
+            lecture_tree.erase(lecture);
+        }
+
+        int size() const
+        {
+            return lecture_tree.size();
+        }
+
+        // The B+ tree allocates its nodes one at a time as they split, so there is no room to prepare.
+        void reserve(int count) { }
+
+        const LectureContainer& ith(int i) const
+        {
+            return *find(i);
+        }
+
+        void range(int from, int to, int* course_ids, int* class_ids) const
+        {
+            LectureTree::const_iterator current = find(from);
+            for(int k = 0; k <= to - from; k++, --current) // The ranking goes from the highest key down
+            {
+                course_ids[k] = current->course();
+                class_ids[k] = current->lecture();
+            }
+        }
+
+        // The class of the first rank is found with one descent, and every next one by walking down the leaves
+        // from the last, unless it is more than MAX_WALK classes away, where a new descent is cheaper.
+        void batch(const int* ranks, int count, int* course_ids, int* class_ids) const
+        {
+            LectureTree::const_iterator current = find(ranks[0]);
+            for(int i = 0; i < count; i++)
+            {
+                int gap = i? ranks[i] - ranks[i - 1] : 0;
+                if(gap > MAX_WALK)
+                {
+                    current = find(ranks[i]);
+                }
+                else
+                {
+                    current -= gap; // The ranking goes from the highest key down
+                }
+                course_ids[i] = current->course();
+                class_ids[i] = current->lecture();
+            }
+        }
+
+        int rankOf(const LectureContainer& lecture) const
+        {
+            return lecture_tree.size() - lecture_tree.countLower(lecture);
+        }
+    };
+}
+#endif
@@ -1,35 +1,48 @@
 #ifndef _AVL_T
 #define _AVL_T
 #include <memory>
+#include <algorithm>
+#include <iterator>
+#include <utility>
 #include <assert.h>
+#include "NodeStorage.h"
+#include "../DynamicArray/Array.h"
 #include "../Exceptions/Exceptions.h"
 
 namespace DS
 {
-    //Declaration of a template node struct
-    template<typename KEY_TYPE, typename VAL_TYPE>
-    struct graph_node
+    // Picks the class whose rotations the tree uses: DERIVED, or the AVL itself when there is none.
+    template<class DERIVED, class BASE>
+    struct MostDerived
     {
-        KEY_TYPE key;
-        VAL_TYPE val;
-        int height = 0;
-        std::shared_ptr<graph_node<KEY_TYPE, VAL_TYPE>> father;
-        std::shared_ptr<graph_node<KEY_TYPE, VAL_TYPE>> left;
-        std::shared_ptr<graph_node<KEY_TYPE, VAL_TYPE>> right;
-        virtual ~graph_node() = default;
+        typedef DERIVED type;
     };
 
-    // The class NODE in the template must inherit from graph_node for it to work properly.
-    template<typename KEY_TYPE=int, typename VAL_TYPE=int, class NODE=graph_node<KEY_TYPE, VAL_TYPE>> 
+    template<class BASE>
+    struct MostDerived<void, BASE>
+    {
+        typedef BASE type;
+    };
+
+    // STORAGE is a node storage policy (see NodeStorage.h):
+    // SharedNodes links the nodes with shared pointers, NodePool keeps them in a contiguous slab.
+    // DERIVED is the class that derives from the AVL (CRTP), if any. Its rotateRight and rotateLeft
+    // hide the AVL's, and are bound at compile time, so a plain AVL has no virtual functions.
+    template<typename KEY_TYPE=int, typename VAL_TYPE=int, class STORAGE=SharedNodes<KEY_TYPE, VAL_TYPE>, class DERIVED=void>
     class AVL
     {
+    public:
+        typedef typename STORAGE::node_type NODE;
+        typedef typename STORAGE::link link;
+
         /*********************************/
         /*       Protected Section       */
         /*********************************/
     protected:
-        std::shared_ptr<NODE> tree_root;
-        std::shared_ptr<NODE> leftmost_node;
-        std::shared_ptr<NODE> rightmost_node;
+        STORAGE nodes;
+        link tree_root;
+        link leftmost_node;
+        link rightmost_node;
         int node_count;
 
         /* Private Functions: */
@@ -40,234 +53,462 @@ namespace DS
         {
             return (a > b)? a : b;
         }
-        
+
+        typedef typename MostDerived<DERIVED, AVL>::type Self;
+
+        // Return the most derived tree, whose rotations are used by the rebalancing code.
+        Self& self()
+        {
+            return static_cast<Self&>(*this);
+        }
+
         // Return the height of node.
-        static int height(const std::shared_ptr<NODE>& node)
+        int height(const link& node) const
         {
-            if(node == nullptr)
+            if(!node)
             {
                 return -1;
             }
-            return node->height;
+            return nodes[node].height;
         }
 
-        // Helper function that allocates and returns a shared pointer to a new node for the tree.
-        static std::shared_ptr<NODE> newNode(const KEY_TYPE& key, const VAL_TYPE& val, const std::shared_ptr<NODE>& father = nullptr)
+        // Helper function that allocates and returns a link to a new node for the tree.
+        // The value is moved into the node when val is an rvalue.
+        template<class VAL>
+        link newNode(const KEY_TYPE& key, VAL&& val, const link& father = link())
         {
-            std::shared_ptr<NODE> node = std::make_shared<NODE>();
-            node->key = key;
-            node->val = val;
-            node->height = 0;
-            node->left = nullptr;
-            node->right = nullptr;
-            node->father = father;
+            link node = nodes.allocate();
+            NODE& new_node = nodes[node];
+            new_node.key = key;
+            new_node.val = std::forward<VAL>(val);
+            new_node.height = 0;
+            new_node.left = link();
+            new_node.right = link();
+            new_node.father = father;
             return node;
         }
 
         // Get the balance factor of a node
-        static int getBalance(const std::shared_ptr<NODE>& node)
+        int getBalance(const link& node) const
         {
-            if(node == nullptr)
+            if(!node)
             {
                 return 0;
             }
-            return height(node->left) - height(node->right);
+            return height(nodes[node].left) - height(nodes[node].right);
         }
 
-        // Deepcopy src tree into dest tree
-        static void deepcopy(std::shared_ptr<NODE>& dest, const std::shared_ptr<NODE>& src)
+        // Deepcopy the src subtree of other into this tree, and return the root of the copy.
+        link deepcopy(const AVL& other, const link& src, const link& father)
         {
-            if(src == nullptr)
+            if(!src)
             {
-                return;
+                return link();
+            }
+            link dest = nodes.allocate();
+            nodes[dest] = other.nodes[src];
+            nodes[dest].father = father;
+            link left = deepcopy(other, other.nodes[src].left, dest);
+            link right = deepcopy(other, other.nodes[src].right, dest);
+            nodes[dest].left = left;
+            nodes[dest].right = right;
+            return dest;
+        }
+
+        // A functor for buildSorted, for trees that keep nothing but heights in their nodes.
+        class NoFinish
+        {
+        public:
+            void operator()(const link& node) { }
+        };
+
+        // Gives insertAux the node of a new key, holding a value that is copied or moved (if VAL is not a reference) into it,
+        // and overwrites the value of a key that is already in the tree the same way.
+        template<class VAL>
+        class NewValue
+        {
+        public:
+            NewValue(AVL& tree, VAL&& val) : tree(tree), val(std::forward<VAL>(val)) { }
+
+            link make(const KEY_TYPE& key, const link& father)
+            {
+                return tree.newNode(key, std::forward<VAL>(val), father);
+            }
+
+            void overwrite(NODE& node)
+            {
+                node.val = std::forward<VAL>(val);
+            }
+
+        private:
+            AVL& tree;
+            VAL&& val;
+        };
+
+        // Gives insertAux a node that extractAll unlinked from the tree from, relinked (with a SharedNodes storage)
+        // or moved (with a NodePool storage) rather than allocated, and moves its value over if its key is already in the tree.
+        class Relinked
+        {
+        public:
+            Relinked(AVL& tree, AVL& from, const link& node) : tree(tree), from(from), node(node) { }
+
+            link make(const KEY_TYPE& key, const link& father)
+            {
+                link moved = tree.nodes.adopt(from.nodes, node);
+                NODE& new_node = tree.nodes[moved];
+                new_node.height = 0;
+                new_node.left = link();
+                new_node.right = link();
+                new_node.father = father;
+                return moved;
+            }
+
+            void overwrite(NODE& existing)
+            {
+                existing.val = std::move(from.nodes[node].val);
+            }
+
+        private:
+            AVL& tree;
+            AVL& from;
+            link node;
+        };
+
+        // Builds a perfectly balanced tree out of the next count keys of a sorted sequence, and returns its root.
+        // finish is called for each node once both of its sub trees are built.
+        template<class ITERATOR, class FINISH>
+        link buildSorted(ITERATOR& it, int count, const link& father, FINISH& finish)
+        {
+            if(count <= 0)
+            {
+                return link();
+            }
+            int left_count = (count - 1)/2;
+            link left = buildSorted(it, left_count, link(), finish);
+            link root = newNode(*it, VAL_TYPE(), father);
+            ++it;
+            link right = buildSorted(it, count - left_count - 1, root, finish);
+
+            NODE& node = nodes[root];
+            node.left = left;
+            node.right = right;
+            if(left)
+            {
+                nodes[left].father = root;
+            }
+            node.height = max(height(left), height(right)) + 1;
+            finish(root);
+            return root;
+        }
+
+        // Replaces the contents of the tree with the keys of a sorted sequence.
+        template<class ITERATOR, class FINISH>
+        void assignSortedAux(ITERATOR begin, ITERATOR end, FINISH& finish)
+        {
+            int count = countKeys(begin, end);
+            deleteTree(tree_root);
+            leftmost_node = rightmost_node = link();
+            node_count = 0;
+
+            nodes.reserve(count);
+            tree_root = buildSorted(begin, count, link(), finish);
+            node_count = count;
+            if(tree_root)
+            {
+                leftmost_node = findLowestNode(tree_root);
+                rightmost_node = findHighestNode(tree_root);
+            }
+        }
+
+        // Copies the keys of a sequence into keys, sorts them and drops duplicates.
+        // keys must have room for the whole sequence. Returns the number of distinct keys.
+        template<class ITERATOR>
+        static int sortKeys(ITERATOR begin, ITERATOR end, Array<KEY_TYPE>& keys)
+        {
+            int count = 0;
+            for(ITERATOR it = begin; it != end; ++it)
+            {
+                keys[count++] = *it;
+            }
+            if(count == 0)
+            {
+                return 0;
+            }
+            KEY_TYPE* first = &keys[0];
+            std::sort(first, first + count);
+            return std::unique(first, first + count) - first;
+        }
+
+        // Returns the number of elements in a sequence.
+        template<class ITERATOR>
+        static int countKeys(ITERATOR begin, ITERATOR end)
+        {
+            int count = 0;
+            for(ITERATOR it = begin; it != end; ++it)
+            {
+                count++;
             }
-            // newNode(const KEY_TYPE& key, const VAL_TYPE& val, const std::shared_ptr<NODE>& father = nullptr)
-            dest = newNode(src->key, src->val, src->father);
-            *dest = *src;
-            deepcopy(dest->left, src->left);
-            deepcopy(dest->right, src->right);
+            return count;
         }
 
         /*   Class Private Methods   */
         // General right and left rotations for balanced trees, return the new root of the tree.
-        virtual std::shared_ptr<NODE> rotateRight(std::shared_ptr<NODE>& sub_root)
+        link rotateRight(link sub_root)
         {
-            std::shared_ptr<NODE> father = sub_root->father;
-            std::shared_ptr<NODE> L_sub = sub_root->left;
-            std::shared_ptr<NODE> LR_sub = L_sub->right;
+            NODE& root = nodes[sub_root];
+            link L_sub = root.left;
+            NODE& left = nodes[L_sub];
+            link LR_sub = left.right;
 
             // Do the rotation:
-            L_sub->right = sub_root;
-            sub_root->left = LR_sub;
-            L_sub->father = father; // Update the fathers
-            sub_root->father = L_sub;
+            left.right = sub_root;
+            root.left = LR_sub;
+            left.father = root.father; // Update the fathers
+            root.father = L_sub;
             if(LR_sub)
             {
-                LR_sub->father = sub_root;
+                nodes[LR_sub].father = sub_root;
             }
 
             // Update the new heights:
-            sub_root->height = max(height(sub_root->left), height(sub_root->right)) + 1;
-            L_sub->height = max(height(L_sub->left), height(L_sub->right)) + 1;
+            root.height = max(height(root.left), height(root.right)) + 1;
+            left.height = max(height(left.left), height(left.right)) + 1;
 
             // Return the new sub root
             return L_sub;
         }
 
 
-        virtual std::shared_ptr<NODE> rotateLeft(std::shared_ptr<NODE>& sub_root)
+        link rotateLeft(link sub_root)
         {
-            std::shared_ptr<NODE> father = sub_root->father;
-            std::shared_ptr<NODE> R_sub = sub_root->right;
-            std::shared_ptr<NODE> RL_sub = R_sub->left;
+            NODE& root = nodes[sub_root];
+            link R_sub = root.right;
+            NODE& right = nodes[R_sub];
+            link RL_sub = right.left;
 
             // Do the rotation:
-            R_sub->left = sub_root;
-            sub_root->right = RL_sub;
-            R_sub->father = father; // Update the fathers
-            sub_root->father = R_sub;
+            right.left = sub_root;
+            root.right = RL_sub;
+            right.father = root.father; // Update the fathers
+            root.father = R_sub;
             if(RL_sub)
             {
-                RL_sub->father = sub_root;
+                nodes[RL_sub].father = sub_root;
             }
 
             // Update the new heights:
-            sub_root->height = max(height(sub_root->left), height(sub_root->right)) + 1;
-            R_sub->height = max(height(R_sub->left), height(R_sub->right)) + 1;
+            root.height = max(height(root.left), height(root.right)) + 1;
+            right.height = max(height(right.left), height(right.right)) + 1;
 
             // Return the new sub root
             return R_sub;
         }
 
-        // An auxiliary insert method for the class' use.
-        virtual std::shared_ptr<NODE> insertAux(const KEY_TYPE& key, const VAL_TYPE& val, std::shared_ptr<NODE>& root)
+        // An auxiliary insert method for the class' use. Sets inserted to the node that holds key.
+        // The node of a new key is made by inserter (see NewValue and Relinked).
+        // Allocating a node may move the storage, so links are re-read after every allocation.
+        template<class INSERTER>
+        link insertAux(const KEY_TYPE& key, INSERTER& inserter, link root, link& inserted)
         {
-            assert(root != nullptr);
+            assert(root);
             // 1. Do a normal BST rotation:
-            if(root->key > key)
+            if(nodes[root].key > key)
             {
-                if(root->left == nullptr)
+                if(!nodes[root].left)
                 {
-                    root->left = newNode(key, val, root);
-                    root->height = max(height(root->left), height(root->right)) + 1;
+                    link new_node = inserter.make(key, root);
+                    nodes[root].left = new_node;
+                    nodes[root].height = max(height(nodes[root].left), height(nodes[root].right)) + 1;
                     node_count++;
+                    inserted = new_node;
                     return root;
                 }
-                root->left = insertAux(key, val, root->left);
+                link new_left = insertAux(key, inserter, nodes[root].left, inserted);
+                nodes[root].left = new_left;
             }
-            else if(root->key < key)
+            else if(nodes[root].key < key)
             {
-                if(root->right == nullptr)
+                if(!nodes[root].right)
                 {
-                    root->right = newNode(key, val, root);
-                    root->height = max(height(root->left), height(root->right)) + 1;
+                    link new_node = inserter.make(key, root);
+                    nodes[root].right = new_node;
+                    nodes[root].height = max(height(nodes[root].left), height(nodes[root].right)) + 1;
                     node_count++;
+                    inserted = new_node;
                     return root;
                 }
-                root->right = insertAux(key, val, root->right);
+                link new_right = insertAux(key, inserter, nodes[root].right, inserted);
+                nodes[root].right = new_right;
             }
             else //There already exists a node with the same key, so overwrite it's contents.
             {
-                root->val = val;
+                inserter.overwrite(nodes[root]);
+                inserted = root;
                 return root;
             }
 
+            NODE& node = nodes[root];
             // 2. Update the height of all the nodes in the BST search.
-            root->height = max(height(root->left), height(root->right)) + 1;
+            node.height = max(height(node.left), height(node.right)) + 1;
 
             // 3. Verify balance factors, and perform rotations if needed.
             int balance_fact = getBalance(root);
             // RR Rotation:
-            if((balance_fact < -1) && (root->right->key < key))
+            if((balance_fact < -1) && (nodes[node.right].key < key))
             {
-                return rotateLeft(root);
+                return self().rotateLeft(root);
             }
             // LL Rotation:
-            if((balance_fact > 1) && (root->left->key > key))
+            if((balance_fact > 1) && (nodes[node.left].key > key))
             {
-                return rotateRight(root);
+                return self().rotateRight(root);
             }
             // RL Rotation:
-            if((balance_fact < -1) && (root->right->key > key))
+            if((balance_fact < -1) && (nodes[node.right].key > key))
             {
-                root->right = rotateRight(root->right);
-                return rotateLeft(root);
+                node.right = self().rotateRight(node.right);
+                return self().rotateLeft(root);
             }
             // LR Rotation:
-            if((balance_fact > 1) && (root->left->key < key))
+            if((balance_fact > 1) && (nodes[node.left].key < key))
             {
-                root->left = rotateLeft(root->left);
-                return rotateRight(root);
+                node.left = self().rotateLeft(node.left);
+                return self().rotateRight(root);
             }
             return root;
-        } 
+        }
 
         // Finds the lowest (leftmost) node from the given root
-        std::shared_ptr<NODE> findLowestNode(const std::shared_ptr<NODE>& root) const
+        link findLowestNode(const link& root) const
         {
-            std::shared_ptr<NODE> left_child = root;
-            while(left_child->left != nullptr)
+            link left_child = root;
+            while(nodes[left_child].left)
             {
-                left_child = left_child->left;
+                left_child = nodes[left_child].left;
             }
             return left_child;
         }
 
         // Finds the highest (rightmost) node from the given root
-        std::shared_ptr<NODE> findHighestNode(const std::shared_ptr<NODE>& root) const
+        link findHighestNode(const link& root) const
         {
-            std::shared_ptr<NODE> right_child = root;
-            while(right_child->right != nullptr)
+            link right_child = root;
+            while(nodes[right_child].right)
             {
-                right_child = right_child->right;
+                right_child = nodes[right_child].right;
             }
             return right_child;
         }
 
+        // Returns the in-order successor of node, or a null link if node holds the highest key.
+        link nextNode(link node) const
+        {
+            if(nodes[node].right)
+            {
+                return findLowestNode(nodes[node].right);
+            }
+            link father = nodes[node].father;
+            while(father && nodes[father].right == node)
+            {
+                node = father;
+                father = nodes[node].father;
+            }
+            return father;
+        }
+
+        // Returns the in-order predecessor of node, or a null link if node holds the lowest key.
+        link prevNode(link node) const
+        {
+            if(nodes[node].left)
+            {
+                return findHighestNode(nodes[node].left);
+            }
+            link father = nodes[node].father;
+            while(father && nodes[father].left == node)
+            {
+                node = father;
+                father = nodes[node].father;
+            }
+            return father;
+        }
+
+        // Moves the links to the lowest and highest nodes off node, before it is unlinked from the tree.
+        // The lowest node has no left child and the highest no right child, so this takes O(1).
+        void unlinkEdges(const link& node)
+        {
+            if(node == leftmost_node)
+            {
+                leftmost_node = nextNode(node);
+            }
+            if(node == rightmost_node)
+            {
+                rightmost_node = prevNode(node);
+            }
+        }
+
+        // Points the links to the lowest and highest nodes to node, after it was linked to the tree.
+        void linkEdges(const link& node)
+        {
+            if(!leftmost_node || nodes[node].key < nodes[leftmost_node].key)
+            {
+                leftmost_node = node;
+            }
+            if(!rightmost_node || nodes[rightmost_node].key < nodes[node].key)
+            {
+                rightmost_node = node;
+            }
+        }
+
+        // Finds the node that holds key, or a null link if there is none.
+        link findNode(const KEY_TYPE& key) const
+        {
+            link node = tree_root;
+            while(node && nodes[node].key != key)
+            {
+                node = (key > nodes[node].key)? nodes[node].right : nodes[node].left;
+            }
+            return node;
+        }
+
         // An auxiliary eraese method for the class' use.
-        virtual std::shared_ptr<NODE> eraseAux(std::shared_ptr<NODE>& root, const KEY_TYPE& key)
+        link eraseAux(link root, const KEY_TYPE& key)
         {
             // Search the node in BST
-            if (root == nullptr)
+            if (!root)
             {
                 return root;
             }
-            if (key < root->key)
+            if (key < nodes[root].key)
             {
-                root->left = eraseAux(root->left, key);
+                link new_left = eraseAux(nodes[root].left, key);
+                nodes[root].left = new_left;
             }
-            else if (key > root->key)
+            else if (key > nodes[root].key)
             {
-                root->right = eraseAux(root->right, key);
+                link new_right = eraseAux(nodes[root].right, key);
+                nodes[root].right = new_right;
             }
             // If root->key==key then that's the node we want to delete
             else
             {
                 // If the root has up to 1 child:
-                if(root->left == nullptr || root->right == nullptr)
+                if(!nodes[root].left || !nodes[root].right)
                 {
-                    std::shared_ptr<NODE> child = root->left? root->left : root->right;
+                    link child = nodes[root].left? nodes[root].left : nodes[root].right;
 
                     // If there are no children at all
-                    if (child==nullptr)
+                    if (!child)
                     {
-                        root = nullptr;
+                        nodes.release(root);
+                        root = link();
                         node_count--; // Decrement the count of nodes in the tree
                     }
-                    // Only one child
+                    // Only one child, which takes the place of root
                     else
                     {
-                        child->father = root->father;
-                        *(root) = *(child);
-                        // Update the children's father to his new address:
-                        if(child->right)
-                        {
-                            child->right->father = root;
-                        }
-                        if(child->left)
-                        {
-                            child->left->father = root;
-                        }
+                        nodes[child].father = nodes[root].father;
+                        nodes.release(root);
+                        root = child;
                         node_count--; // Decrement the count of nodes in the tree
                     }
                 }
@@ -275,193 +516,258 @@ namespace DS
                 else
                 {
                     // Find the root's replacement node:
-                    std::shared_ptr<NODE> nextMin = findLowestNode(root->right);
-                    // Backup the pointers of root before we override them
-                    std::shared_ptr<NODE> rootOldLeftChild = root->left;
-                    std::shared_ptr<NODE> rootOldRightChild = root->right;
-                    std::shared_ptr<NODE> rootOldFather = root->father;
-                    *(root) = *(nextMin); // Overwrite root with his replacement
-                    root->left = rootOldLeftChild; // Restore the original pointers
-                    root->father = rootOldFather;
-                    root->right = rootOldRightChild;
-                    root->right = eraseAux(root->right, nextMin->key);
+                    link nextMin = findLowestNode(nodes[root].right);
+                    // Backup the links of root before we override them
+                    link rootOldLeftChild = nodes[root].left;
+                    link rootOldRightChild = nodes[root].right;
+                    link rootOldFather = nodes[root].father;
+                    nodes[root] = nodes[nextMin]; // Overwrite root with his replacement
+                    nodes[root].left = rootOldLeftChild; // Restore the original links
+                    nodes[root].father = rootOldFather;
+                    nodes[root].right = rootOldRightChild;
+                    link new_right = eraseAux(rootOldRightChild, nodes[root].key);
+                    nodes[root].right = new_right;
                 }
             }
 
             // If a leaf was deleted:
-            if (root == nullptr)
+            if (!root)
             {
                 return root;
             }
+            NODE& node = nodes[root];
             // Update heights:
-            root->height = max(height(root->right), height(root->left)) + 1;
+            node.height = max(height(node.right), height(node.left)) + 1;
             // Confirm balance factors:
             int balance_fact = getBalance(root);
             // If the node is unbalanced then we need two rotations according to the 4 cases:
             if (balance_fact > 1)
             {
-                if (getBalance(root->left) >= 0) // LL rotation
+                if (getBalance(node.left) >= 0) // LL rotation
                 {
-                    return rotateRight(root);
+                    return self().rotateRight(root);
                 }
                 else // LR rotation
                 {
-                    root->left = rotateLeft(root->left);
-                    return rotateRight(root);
+                    node.left = self().rotateLeft(node.left);
+                    return self().rotateRight(root);
                 }
             }
             if (balance_fact < -1)
             {
-                if (getBalance(root->right) <= 0)  //RR rotation
+                if (getBalance(node.right) <= 0)  //RR rotation
                 {
-                    return rotateLeft(root);
+                    return self().rotateLeft(root);
                 }
                 else //RL rotation
                 {
-                    root->right = rotateRight(root->right);
-                    return rotateLeft(root);
+                    node.right = self().rotateRight(node.right);
+                    return self().rotateLeft(root);
                 }
             }
             return root;
         }
 
-        // An auxiliary function for inOrder.
-        template<class FUNCTOR>
-        void leftmostInOrderAux(const std::shared_ptr<NODE>& p, int* k, FUNCTOR& func) const
-        {
-            if(p == NULL || *k == 0) return;
-
-            func(p, k);
-            inOrderAux(p->right, k, func);
-            leftmostInOrderAux(p->father, k, func);
-        }
-
-        // An auxiliary function for inOrder.
-        // The functor must decrease k for the number of nodes it has taken care of
+        // An auxiliary function for preOrder.
         template<class FUNCTOR>
-        void inOrderAux(const std::shared_ptr<NODE>& p, int* k, FUNCTOR& func) const
+        void preOrderAux(const link& p, int* k, FUNCTOR& func) const
         {
-            if(p == NULL || *k == 0) return;
-
-            inOrderAux(p->left, k, func);
-            func(p, k);
-            inOrderAux(p->right, k, func);
-        }
+            if(!p || *k == 0) return;
 
-        // An auxiliary function for reverseInOrder.
-        template<class FUNCTOR>
-        void rightmostReverseInOrderAux(const std::shared_ptr<NODE>& p, int* k, FUNCTOR& func) const
-        {
-            if(p == NULL || *k == 0) return;
-            func(p);
+            func(nodes[p]);
             (*k)--;
-            reverseInOrderAux(p->left, k, func);
-            rightmostReverseInOrderAux(p->father, k, func);
+            preOrderAux(nodes[p].left, k, func);
+            preOrderAux(nodes[p].right, k, func);
         }
 
-        // An auxiliary function for reverseInOrder.
+        // An auxiliary function for postOrder.
         template<class FUNCTOR>
-        void reverseInOrderAux(const std::shared_ptr<NODE>& p, int* k, FUNCTOR& func) const
+        void postOrderAux(const link& p, int* k, FUNCTOR& func) const
         {
-            if(p == NULL || *k == 0) return;
+            if(!p || *k == 0) return;
 
-            reverseInOrderAux(p->right, k, func);
+            postOrderAux(nodes[p].left, k, func);
+            postOrderAux(nodes[p].right, k, func);
             if(*k == 0)
             {
                 return;
             }
-            func(p);
+            func(nodes[p]);
             (*k)--;
-            if(*k == 0)
-            {
-                return;
-            }
-            reverseInOrderAux(p->left, k, func);
         }
 
-        // An auxiliary function for preOrder.
-        template<class FUNCTOR>
-        void preOrderAux(const std::shared_ptr<NODE>& p, int* k, FUNCTOR& func) const
+        void deleteTree(link& root)
         {
-            if(p == NULL || k == 0) return;
-
-            func(p);
-            (*k)--;
-            preOrderAux(p->left, func);
-            preOrderAux(p->right, func);
+            nodes.clear(root);
         }
 
-        // An auxiliary function for postOrder.
-        template<class FUNCTOR>
-        void postOrderAux(const std::shared_ptr<NODE>& p, int* k, FUNCTOR& func) const
+        // Inserts key into the tree, with the node inserter makes for it, and returns the node it is stored in.
+        template<class INSERTER>
+        link insertWith(const KEY_TYPE& key, INSERTER& inserter)
         {
-            if(p == NULL || k == 0) return;
-
-            postOrderAux(p->left, func);
-            postOrderAux(p->right, func);
-            func(p);
-            (*k)--;
+            if(!tree_root)
+            {
+                tree_root = inserter.make(key, link());
+                leftmost_node = rightmost_node = tree_root;
+                node_count++;
+                return tree_root;
+            }
+            link inserted;
+            tree_root = insertAux(key, inserter, tree_root, inserted);
+            linkEdges(inserted);
+            return inserted;
         }
 
-        void deleteTree(std::shared_ptr<NODE>& root) 
+        // An auxiliary function for extractAll. Unlinks the nodes of the sub tree rooted at node and passes them to sink.
+        template<class SINK>
+        void extractAux(link node, SINK& sink)
         {
-            if (root != nullptr) 
+            if(!node)
             {
-                deleteTree(root->left);
-                deleteTree(root->right);
-                root = nullptr;
+                return;
             }
+            link left = nodes[node].left;
+            link right = nodes[node].right;
+            nodes[node].left = nodes[node].right = nodes[node].father = link();
+            extractAux(left, sink);
+            extractAux(right, sink);
+            sink(*this, node, nodes[node].key);
         }
 
         /**********************************/
         /*         Public Section         */
         /**********************************/
     public:
+        /*
+         * Class: const_iterator
+         * ---------------------------------------
+         * A bidirectional iterator over the nodes of the tree in ascending key order.
+         * Dereferencing gives a const NODE&, since changing a key would break the tree.
+         * Stepping follows the father links, so a full traversal takes O(n) and each step O(1) amortized.
+         * An iterator stays valid until its node is erased. (with a NodePool storage, the
+         * references it gives are only valid until the next insertion)
+         * Decrementing end() gives the node of the highest key.
+         */
+        class const_iterator
+        {
+        public:
+            typedef std::bidirectional_iterator_tag iterator_category;
+            typedef NODE value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const NODE* pointer;
+            typedef const NODE& reference;
+
+            const_iterator() : tree(nullptr), node() { }
+
+            reference operator*() const
+            {
+                return tree->nodes[node];
+            }
+
+            pointer operator->() const
+            {
+                return tree->nodes.ptr(node);
+            }
+
+            const_iterator& operator++()
+            {
+                node = tree->nextNode(node);
+                return *this;
+            }
+
+            const_iterator operator++(int)
+            {
+                const_iterator old = *this;
+                ++(*this);
+                return old;
+            }
+
+            const_iterator& operator--()
+            {
+                node = node? tree->prevNode(node) : tree->rightmost_node;
+                return *this;
+            }
+
+            const_iterator operator--(int)
+            {
+                const_iterator old = *this;
+                --(*this);
+                return old;
+            }
+
+            bool operator==(const const_iterator& other) const
+            {
+                return node == other.node;
+            }
+
+            bool operator!=(const const_iterator& other) const
+            {
+                return !(*this == other);
+            }
+
+        private:
+            friend class AVL;
+            const AVL* tree;
+            link node;
+
+            const_iterator(const AVL* tree, const link& node) : tree(tree), node(node) { }
+        };
+        typedef const_iterator iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+        typedef const_reverse_iterator reverse_iterator;
+
         /*
          * Constructor: AVL
-         * Usage: AVL<KEY_TYPE, VAL_TYPE, NODE> tree(root);
-         *        AVL<KEY_TYPE, VAL_TYPE, NODE> tree();
+         * Usage: AVL<KEY_TYPE, VAL_TYPE, STORAGE> tree(root);
+         *        AVL<KEY_TYPE, VAL_TYPE, STORAGE> tree();
          * ---------------------------------------
          * Create an empty AVL tree, or intialize it with a root using the first syntax.
          * Worst time complexity: O(1)
-         * 
+         *
          * Possible Exceptions:
          * std::bad_alloc
          */
         explicit AVL(const NODE& root) :
-        tree_root(std::make_shared<NODE>(root)), leftmost_node(root), rightmost_node(root), node_count(1) { }
-        explicit AVL() : tree_root(nullptr), leftmost_node(nullptr), rightmost_node(nullptr), node_count(0) { }
+        nodes(), tree_root(), leftmost_node(), rightmost_node(), node_count(1)
+        {
+            tree_root = nodes.allocate();
+            nodes[tree_root] = root;
+            nodes[tree_root].height = 0;
+            nodes[tree_root].father = nodes[tree_root].left = nodes[tree_root].right = link();
+            leftmost_node = rightmost_node = tree_root;
+        }
+        explicit AVL() : nodes(), tree_root(), leftmost_node(), rightmost_node(), node_count(0) { }
 
-        AVL(const AVL<KEY_TYPE, VAL_TYPE,NODE>& other) :
-        tree_root(std::make_shared<NODE>()), leftmost_node(nullptr), rightmost_node(nullptr), node_count(other.node_count)
+        AVL(const AVL& other) :
+        nodes(), tree_root(), leftmost_node(), rightmost_node(), node_count(other.node_count)
         {
-            deepcopy(tree_root, other.tree_root);
-            leftmost_node = findLowestNode(tree_root);
-            rightmost_node = findHighestNode(tree_root);
+            tree_root = deepcopy(other, other.tree_root, link());
+            if(tree_root)
+            {
+                leftmost_node = findLowestNode(tree_root);
+                rightmost_node = findHighestNode(tree_root);
+            }
         }
 
-        AVL& operator=(const AVL<KEY_TYPE, VAL_TYPE,NODE>& other)
+        AVL& operator=(const AVL& other)
         {
+            if(this == &other)
+            {
+                return *this;
+            }
             deleteTree(tree_root);
-
-            class CopyTree
+            leftmost_node = rightmost_node = link();
+            tree_root = deepcopy(other, other.tree_root, link());
+            node_count = other.node_count;
+            if(tree_root)
             {
-            public:
-                AVL<KEY_TYPE,VAL_TYPE,NODE>* this_tree;
-                CopyTree(AVL<KEY_TYPE, VAL_TYPE, NODE>* tree) : this_tree(tree) { }
-                void operator()(const std::shared_ptr<graph_node<KEY_TYPE, VAL_TYPE>>& node, int* k)
-                {
-                    this_tree->insert(node->key, node->val);
-                    (*k)--;
-                }
-            };
-
-            CopyTree functor(this);
-            other.inOrder(functor);
+                leftmost_node = findLowestNode(tree_root);
+                rightmost_node = findHighestNode(tree_root);
+            }
             return *this;
         }
 
-        virtual ~AVL()
+        ~AVL()
         {
             deleteTree(tree_root);
         };
@@ -470,59 +776,140 @@ namespace DS
          * Method: insert
          * Usage: tree.insert(key, val);
          * -----------------------------------
-         * Inserts the pair (key, val) to the AVL tree.
+         * Inserts the pair (key, val) to the AVL tree, and returns the node it is stored in.
+         * An rvalue val is moved into the tree rather than copied.
          * When n is the total number of keys in the tree, the
          * worst time and space complexity for this method is O(log n).
-         * 
+         *
          * Possible Exceptions:
          * std::bad_alloc
          */
-        virtual void insert(const KEY_TYPE& key, const VAL_TYPE& val)
+        link insert(const KEY_TYPE& key, const VAL_TYPE& val)
         {
-            if(tree_root == nullptr)
-            {
-                tree_root = newNode(key, val);
-                leftmost_node = rightmost_node = tree_root;
-                node_count++;
-                return;
-            }
-            tree_root = insertAux(key, val, tree_root);
-            
-            assert(leftmost_node);
-            assert(rightmost_node);
-            if(key < leftmost_node->key)
-            {
-                leftmost_node = findLowestNode(tree_root);
-            }
-            if(key > rightmost_node->key)
-            {
-                rightmost_node = findHighestNode(tree_root);
-            }
+            NewValue<const VAL_TYPE&> value(*this, val);
+            return insertWith(key, value);
+        }
+
+        link insert(const KEY_TYPE& key, VAL_TYPE&& val)
+        {
+            NewValue<VAL_TYPE> value(*this, std::move(val));
+            return insertWith(key, value);
         }
-        
+
+        /*
+         * Method: extractAll
+         * Usage: tree.extractAll(sink);
+         * -----------------------------------
+         * Empties the tree, unlinking its nodes one by one and calling sink(tree, node, key) with each of them,
+         * so sink can hand them to insertNode of other trees. Nodes that sink does not hand over are freed.
+         * key is only valid until node is handed over.
+         * When n is the total number of keys in the tree, the
+         * worst time complexity for this method is O(n), besides the calls to sink.
+         */
+        template<class SINK>
+        void extractAll(SINK& sink)
+        {
+            link root = tree_root;
+            tree_root = leftmost_node = rightmost_node = link();
+            node_count = 0;
+            extractAux(root, sink);
+            link none = link(); // root may belong to another tree by now, so only the storage itself is cleared
+            deleteTree(none);
+        }
+
+        /*
+         * Method: insertNode
+         * Usage: tree.insertNode(from, node);
+         * -----------------------------------
+         * Inserts a node that from.extractAll handed out, with its key and value, and returns the node it is stored in.
+         * With a SharedNodes storage the node itself is linked into the tree, so nothing is allocated or copied.
+         * With a NodePool storage it is moved into the pool of the tree. If its key is already in the tree,
+         * only its value is moved over.
+         * When n is the total number of keys in the tree, the
+         * worst time and space complexity for this method is O(log n).
+         *
+         * Possible Exceptions:
+         * std::bad_alloc (NodePool storage only)
+         */
+        link insertNode(AVL& from, const link& node)
+        {
+            KEY_TYPE key = from.nodes[node].key; // A NodePool frees the cell of node in from once it is moved
+            Relinked relinked(*this, from, node);
+            return insertWith(key, relinked);
+        }
+
         /*
          * Method: erase
          * Usage: tree.erase(key);
          * -----------------------------------
          * Erases the pair corresponding to 'key' from the AVL tree.
+         * The lowest and highest nodes are updated in O(1), without walking the tree again.
          * When n is the total number of keys in the tree, the
          * worst time and space complexity for this method is O(log n).
          */
-        virtual void erase(const KEY_TYPE& key)
+        void erase(const KEY_TYPE& key)
         {
-            tree_root = eraseAux(tree_root, key);
-            if(tree_root)
+            if(!tree_root)
             {
-                assert(leftmost_node);
-                assert(rightmost_node);
-                leftmost_node = findLowestNode(tree_root);
-                rightmost_node = findHighestNode(tree_root);
+                return;
             }
-            else
+            // The lowest and highest nodes have up to 1 child, so they are unlinked rather than copied into.
+            // A node with two children takes the contents of its successor, which may be the highest node.
+            link before_highest = prevNode(rightmost_node);
+            if(key == nodes[leftmost_node].key)
             {
-                leftmost_node = nullptr;
-                rightmost_node = nullptr;
+                leftmost_node = nextNode(leftmost_node);
             }
+            if(key == nodes[rightmost_node].key)
+            {
+                rightmost_node = before_highest;
+            }
+            else if(before_highest && key == nodes[before_highest].key && nodes[before_highest].left)
+            {
+                rightmost_node = before_highest;
+            }
+            tree_root = eraseAux(tree_root, key);
+        }
+
+        /*
+         * Method: assignSorted
+         * Usage: tree.assignSorted(begin, end);
+         * -----------------------------------
+         * Replaces the contents of the tree with the keys in [begin, end),
+         * which must be sorted in ascending order and contain no duplicates.
+         * Every key is mapped to VAL_TYPE(), and the result is a perfectly balanced tree.
+         * The iterators are passed over twice, so they have to be forward iterators.
+         * When n is the number of keys in the sequence, the
+         * worst time and space complexity for this method is O(n).
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        template<class ITERATOR>
+        void assignSorted(ITERATOR begin, ITERATOR end)
+        {
+            NoFinish finish;
+            assignSortedAux(begin, end, finish);
+        }
+
+        /*
+         * Method: assignUnsorted
+         * Usage: tree.assignUnsorted(begin, end);
+         * -----------------------------------
+         * Same as assignSorted, but sorts the keys in [begin, end) first.
+         * Duplicate keys are only inserted once.
+         * When n is the number of keys in the sequence, the
+         * worst time complexity for this method is O(n log n) and the space complexity is O(n).
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        template<class ITERATOR>
+        void assignUnsorted(ITERATOR begin, ITERATOR end)
+        {
+            Array<KEY_TYPE> keys(countKeys(begin, end));
+            int count = sortKeys(begin, end, keys);
+            assignSorted(&keys[0], &keys[0] + count);
         }
 
         /*
@@ -531,6 +918,9 @@ namespace DS
          *        tree.inOrder(functor, k);
          * -----------------------------------
          * Applies the functor for k nodes in an in-order traversal.
+         * The functor is called as func(const NODE& node, int* k),
+         * and must decrease k for the number of nodes it has taken care of.
+         * The traversal walks the father links, so it does not recurse.
          * Input a negative number for k or do not input it to get a full tree traversal.
          * For proper use of this method, do not attempt to change the nodes of the tree.
          * When n is the total number of keys in the tree, the
@@ -544,7 +934,10 @@ namespace DS
             {
                 k = node_count;
             }
-            leftmostInOrderAux(leftmost_node, &k, func);
+            for(link p = leftmost_node; p && k != 0; p = nextNode(p))
+            {
+                func(nodes[p], &k);
+            }
         }
 
         /*
@@ -553,6 +946,8 @@ namespace DS
          *        tree.reverseInOrder(functor, k);
          * -----------------------------------
          * Applies the functor for k nodes in a reverse in-order traversal.
+         * The functor is called as func(const NODE& node).
+         * The traversal walks the father links, so it does not recurse.
          * Input a negative number for k or do not input it to get a full tree traversal.
          * For proper use of this method, do not attempt to change the nodes of the tree.
          * When n is the total number of keys in the tree, the
@@ -566,7 +961,10 @@ namespace DS
             {
                 k = node_count;
             }
-            rightmostReverseInOrderAux(rightmost_node, &k, func);
+            for(link p = rightmost_node; p && k != 0; p = prevNode(p), k--)
+            {
+                func(nodes[p]);
+            }
         }
 
         /*
@@ -614,44 +1012,33 @@ namespace DS
          * Method: getNode
          * Usage: tree.getNode(key);
          * -----------------------------------
-         * Finds the key and returns the node it is stored in as a const pointer.
+         * Finds the key and returns the node it is stored in.
          * If the key wasn't found, throws a KeyNotFound exception.
+         * With a NodePool storage the reference is only valid until the next insertion.
          * When n is the total number of keys in the tree, the
          * worst time and space complexity for this method is O(log n).
-         * 
+         *
          * Possible Exceptions (in scope DS::AVL):
          * KeyNotFound.
          */
-        const std::shared_ptr<NODE> getNode(const KEY_TYPE& key)
+        NODE& getNode(const KEY_TYPE& key)
         {
-            std::shared_ptr<NODE> node = tree_root;
+            link node = findNode(key);
             if(!node)
             {
                 throw KeyNotFound();
             }
-            while(node->key != key)
+            return nodes[node];
+        }
+
+        const NODE& getNode(const KEY_TYPE& key) const
+        {
+            link node = findNode(key);
+            if(!node)
             {
-                if(key > node->key)
-                {
-                    if(node->right == nullptr)
-                    {
-                        throw KeyNotFound();
-                    }
-                    node = node->right;
-                    continue;
-                }
-                else if(key < node->key)
-                {
-                    if(node->left == nullptr)
-                    {
-                        throw KeyNotFound();
-                    }
-                    node = node->left;
-                    continue;
-                }
+                throw KeyNotFound();
             }
-            // If we reached this point, node now points to the correct address.
-            return node;
+            return nodes[node];
         }
 
         /*
@@ -662,18 +1049,88 @@ namespace DS
          * If the key wasn't found, throws a KeyNotFound exception.
          * When n is the total number of keys in the tree, the
          * worst time and space complexity for this method is O(log n).
-         * 
+         *
          * Possible Exceptions (in scope DS::AVL):
          * KeyNotFound.
          */
-        VAL_TYPE& at(KEY_TYPE& key)
+        VAL_TYPE& at(const KEY_TYPE& key)
         {
-            return getNode(key)->val;
+            return getNode(key).val;
         }
 
         const VAL_TYPE& at(const KEY_TYPE& key) const
         {
-            return getNode(key)->val;
+            return getNode(key).val;
+        }
+
+        /*
+         * Method: reserve
+         * Usage: tree.reserve(count);
+         * -----------------------------------
+         * Prepares room for count more nodes, so inserting them does not grow the storage.
+         * Only a NodePool storage keeps room, otherwise it does nothing.
+         * Worst time complexity: O(n + count)
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        void reserve(int count)
+        {
+            nodes.reserve(count);
+        }
+
+        /*
+         * Method: prefetchRoot
+         * Usage: tree.prefetchRoot();
+         * -----------------------------------
+         * Hints the processor to start loading the root node into the cache, ahead of a search.
+         * Worst time complexity: O(1)
+         */
+        void prefetchRoot() const
+        {
+#ifdef __GNUC__
+            __builtin_prefetch(nodes.ptr(tree_root));
+#endif
+        }
+
+        /*
+         * Method: prefetchChild
+         * Usage: tree.prefetchChild(key);
+         * -----------------------------------
+         * Hints the processor to start loading the child of the root that a search for key goes down to.
+         * Reads the root, so it should be called a while after prefetchRoot.
+         * Worst time complexity: O(1)
+         */
+        void prefetchChild(const KEY_TYPE& key) const
+        {
+#ifdef __GNUC__
+            if(tree_root)
+            {
+                const NODE& root = nodes[tree_root];
+                __builtin_prefetch(nodes.ptr(key < root.key? root.left : root.right));
+            }
+#endif
+        }
+
+        /*
+         * Method: tryAt
+         * Usage: tree.tryAt(key);
+         * -----------------------------------
+         * Returns a pointer to the value of key, or a null pointer if the key wasn't found.
+         * With a NodePool storage the pointer is only valid until the next insertion.
+         * When n is the total number of keys in the tree, the
+         * worst time and space complexity for this method is O(log n).
+         */
+        VAL_TYPE* tryAt(const KEY_TYPE& key)
+        {
+            link node = findNode(key);
+            return node? &nodes[node].val : nullptr;
+        }
+
+        const VAL_TYPE* tryAt(const KEY_TYPE& key) const
+        {
+            link node = findNode(key);
+            return node? &nodes[node].val : nullptr;
         }
 
         /*
@@ -687,34 +1144,23 @@ namespace DS
          */
         bool find(const KEY_TYPE& key) const noexcept
         {
-            std::shared_ptr<NODE> node = tree_root;
-            if(!node)
-            {
-                return false;
-            }
-            while(node->key != key)
+            const NODE* node = nodes.ptr(tree_root);
+            while(node)
             {
                 if(key > node->key)
                 {
-                    if(node->right == nullptr)
-                    {
-                        return false;
-                    }
-                    node = node->right;
-                    continue;
+                    node = nodes.ptr(node->right);
                 }
                 else if(key < node->key)
                 {
-                    if(node->left == nullptr)
-                    {
-                        return false;
-                    }
-                    node = node->left;
-                    continue;
+                    node = nodes.ptr(node->left);
+                }
+                else
+                {
+                    return true;
                 }
             }
-            // If we reached this point, node now points to the correct address.
-            return true;
+            return false;
         }
 
         /*
@@ -723,12 +1169,12 @@ namespace DS
          * -----------------------------------
          * Returns the node of the lowest key in the tree,
          * In the case that the tree is empty, return a null pointer.
-         * 
+         *
          * The worst time and space complexity for this method is O(1).
          */
-        const std::shared_ptr<NODE>& getLowest() const
+        const NODE* getLowest() const
         {
-            return leftmost_node;
+            return nodes.ptr(leftmost_node);
         }
 
         /*
@@ -737,12 +1183,110 @@ namespace DS
          * -----------------------------------
          * Returns the node of the highest key in the tree,
          * In the case that the tree is empty, return a null pointer.
-         * 
+         *
          * The worst time and space complexity for this method is O(1).
          */
-        const std::shared_ptr<NODE>& getHighest() const
+        const NODE* getHighest() const
+        {
+            return nodes.ptr(rightmost_node);
+        }
+
+    protected:
+        // Returns an iterator to node, for the use of derived trees.
+        const_iterator iteratorAt(const link& node) const
         {
-            return rightmost_node;
+            return const_iterator(this, node);
+        }
+
+    public:
+        /*
+         * Method: begin, end
+         * Usage: for(const auto& node : tree) { ... }
+         * -----------------------------------
+         * Return iterators to the node of the lowest key, and past the node of the highest key.
+         * The worst time and space complexity for these methods is O(1).
+         */
+        const_iterator begin() const
+        {
+            return const_iterator(this, leftmost_node);
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(this, link());
+        }
+
+        /*
+         * Method: rbegin, rend
+         * Usage: for(auto it = tree.rbegin(); it != tree.rend(); ++it) { ... }
+         * -----------------------------------
+         * Return reverse iterators, that go over the nodes from the highest key to the lowest.
+         * The worst time and space complexity for these methods is O(1).
+         */
+        const_reverse_iterator rbegin() const
+        {
+            return const_reverse_iterator(end());
+        }
+
+        const_reverse_iterator rend() const
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        /*
+         * Method: lower_bound
+         * Usage: tree.lower_bound(key);
+         * -----------------------------------
+         * Returns an iterator to the node of the lowest key that is not less than key,
+         * or end() if there is none.
+         * When n is the total number of keys in the tree, the
+         * worst time and space complexity for this method is O(log n).
+         */
+        const_iterator lower_bound(const KEY_TYPE& key) const
+        {
+            link bound = link();
+            link current = tree_root;
+            while(current)
+            {
+                if(nodes[current].key < key)
+                {
+                    current = nodes[current].right;
+                }
+                else
+                {
+                    bound = current;
+                    current = nodes[current].left;
+                }
+            }
+            return const_iterator(this, bound);
+        }
+
+        /*
+         * Method: upper_bound
+         * Usage: tree.upper_bound(key);
+         * -----------------------------------
+         * Returns an iterator to the node of the lowest key that is greater than key,
+         * or end() if there is none.
+         * When n is the total number of keys in the tree, the
+         * worst time and space complexity for this method is O(log n).
+         */
+        const_iterator upper_bound(const KEY_TYPE& key) const
+        {
+            link bound = link();
+            link current = tree_root;
+            while(current)
+            {
+                if(key < nodes[current].key)
+                {
+                    bound = current;
+                    current = nodes[current].left;
+                }
+                else
+                {
+                    current = nodes[current].right;
+                }
+            }
+            return const_iterator(this, bound);
         }
 
         /*
@@ -750,7 +1294,7 @@ namespace DS
          * Usage: tree.size();
          * -----------------------------------
          * Returns the number of nodes in the tree,
-         * 
+         *
          * The worst time and space complexity for this method is O(1).
          */
         int size() const
@@ -759,4 +1303,4 @@ namespace DS
         }
     };
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,342 @@
+#ifndef _AUGMENTATIONS_H
+#define _AUGMENTATIONS_H
+#include <tuple>
+#include <limits>
+#include "RankAVL.h"
+
+namespace DS
+{
+    /*
+     * Augmentations
+     * ---------------------------------------
+     * An augmentation keeps one summary of every sub tree of a RankAVL, built from the keys in it.
+     * Every augmentation exposes:
+     *   value_type           - The type of the summary.
+     *   identity()           - The summary of an empty sub tree.
+     *   single(key)          - The summary of a sub tree with the single key.
+     *   combine(low, high)   - The summary of two neighbouring ranges of keys, low before high.
+     *
+     * Augment<AUGMENTATIONS...> composes them into a RANK functor, whose value_type (a tuple of
+     * the summaries) is the VAL_TYPE of the tree:
+     *     typedef Augment<SubtreeCount, SubtreeSum<ViewsOf>> Ranks;
+     *     RankAVL<Ranks, KEY_TYPE, Ranks::value_type> tree{Ranks()};
+     */
+
+    // Counts the keys of the sub tree.
+    class SubtreeCount
+    {
+    public:
+        typedef int value_type;
+
+        static value_type identity()
+        {
+            return 0;
+        }
+
+        template<typename KEY_TYPE>
+        static value_type single(const KEY_TYPE& key)
+        {
+            return 1;
+        }
+
+        static value_type combine(const value_type& low, const value_type& high)
+        {
+            return low + high;
+        }
+    };
+
+    // Sums PROJECTION(key) over the keys of the sub tree.
+    template<class PROJECTION, typename T=long long>
+    class SubtreeSum
+    {
+    public:
+        typedef T value_type;
+
+        static value_type identity()
+        {
+            return T();
+        }
+
+        template<typename KEY_TYPE>
+        static value_type single(const KEY_TYPE& key)
+        {
+            return PROJECTION()(key);
+        }
+
+        static value_type combine(const value_type& low, const value_type& high)
+        {
+            return low + high;
+        }
+    };
+
+    // Keeps the maximum of PROJECTION(key) over the keys of the sub tree.
+    template<class PROJECTION, typename T=int>
+    class SubtreeMax
+    {
+    public:
+        typedef T value_type;
+
+        static value_type identity()
+        {
+            return std::numeric_limits<T>::lowest();
+        }
+
+        template<typename KEY_TYPE>
+        static value_type single(const KEY_TYPE& key)
+        {
+            return PROJECTION()(key);
+        }
+
+        static value_type combine(const value_type& low, const value_type& high)
+        {
+            return (low < high)? high : low;
+        }
+    };
+
+    // The position of T in LIST. Does not compile if T is not in LIST.
+    template<class T, class... LIST>
+    struct IndexOf;
+
+    template<class T, class... REST>
+    struct IndexOf<T, T, REST...>
+    {
+        static const int value = 0;
+    };
+
+    template<class T, class HEAD, class... REST>
+    struct IndexOf<T, HEAD, REST...>
+    {
+        static const int value = 1 + IndexOf<T, REST...>::value;
+    };
+
+    // Updates the summaries from INDEX on, one augmentation at a time.
+    template<int INDEX, class... LIST>
+    struct AugmentStep
+    {
+        template<class NODE>
+        static void update(NODE& node, const NODE* left, const NODE* right) { }
+    };
+
+    template<int INDEX, class AUGMENTATION, class... REST>
+    struct AugmentStep<INDEX, AUGMENTATION, REST...>
+    {
+        template<class NODE>
+        static void update(NODE& node, const NODE* left, const NODE* right)
+        {
+            typename AUGMENTATION::value_type value = AUGMENTATION::single(node.key);
+            if(left)
+            {
+                value = AUGMENTATION::combine(std::get<INDEX>(left->val), value);
+            }
+            if(right)
+            {
+                value = AUGMENTATION::combine(value, std::get<INDEX>(right->val));
+            }
+            std::get<INDEX>(node.val) = value;
+            AugmentStep<INDEX + 1, REST...>::update(node, left, right);
+        }
+    };
+
+    template<class... AUGMENTATIONS>
+    class Augment
+    {
+    public:
+        typedef std::tuple<typename AUGMENTATIONS::value_type...> value_type;
+
+    private:
+        /*********************************/
+        /*        Private Section        */
+        /*********************************/
+        // The position of the count in the summaries, for the queries that need it.
+        static const int COUNT = IndexOf<SubtreeCount, AUGMENTATIONS...>::value;
+
+        template<class NODE>
+        static int count(const NODE* node)
+        {
+            return node? std::get<COUNT>(node->val) : 0;
+        }
+
+        // Directs a rank search to the i-th highest (or lowest) key.
+        template<class NODE>
+        class FindNth
+        {
+            int i;
+            bool highest;
+        public:
+            FindNth(int i, bool highest) : i(i), highest(highest) { }
+
+            SearchPath operator()(const NODE& node, const NODE* left, const NODE* right)
+            {
+                const NODE* before = highest? right : left;
+                int before_count = count(before);
+                if(i <= before_count)
+                {
+                    return highest? SearchPath::right : SearchPath::left;
+                }
+                i -= before_count + 1;
+                if(i == 0)
+                {
+                    return SearchPath::end;
+                }
+                return highest? SearchPath::left : SearchPath::right;
+            }
+        };
+
+        // Directs a rank search along the edge of the k highest (or lowest) keys, and
+        // combines their summaries into result.
+        template<class AUGMENTATION, class NODE>
+        class CombineEdge
+        {
+            typedef typename AUGMENTATION::value_type summary;
+            int k;
+            bool highest;
+            summary* result;
+        public:
+            CombineEdge(int k, bool highest, summary* result) : k(k), highest(highest), result(result)
+            {
+                *result = AUGMENTATION::identity();
+            }
+
+            SearchPath operator()(const NODE& node, const NODE* left, const NODE* right)
+            {
+                const NODE* before = highest? right : left;
+                int before_count = count(before);
+                if(k <= before_count)
+                {
+                    return highest? SearchPath::right : SearchPath::left;
+                }
+                // The whole sub tree of before and the node itself are taken:
+                summary taken = AUGMENTATION::single(node.key);
+                if(before)
+                {
+                    taken = highest? AUGMENTATION::combine(taken, get<AUGMENTATION>(*before)) :
+                                     AUGMENTATION::combine(get<AUGMENTATION>(*before), taken);
+                }
+                *result = highest? AUGMENTATION::combine(taken, *result) : AUGMENTATION::combine(*result, taken);
+                k -= before_count + 1;
+                if(k == 0)
+                {
+                    return SearchPath::end;
+                }
+                return highest? SearchPath::left : SearchPath::right;
+            }
+        };
+
+        // Ends a rank search right at the root, whose summaries cover the whole tree.
+        class AtRoot
+        {
+        public:
+            template<class NODE>
+            SearchPath operator()(const NODE& node, const NODE* left, const NODE* right)
+            {
+                return SearchPath::end;
+            }
+        };
+
+        template<class AUGMENTATION, class TREE>
+        static typename AUGMENTATION::value_type combineEdge(const TREE& tree, int k, bool highest)
+        {
+            typename AUGMENTATION::value_type result;
+            if(k > tree.size())
+            {
+                k = tree.size();
+            }
+            if(k <= 0)
+            {
+                return AUGMENTATION::identity();
+            }
+            tree.rank(CombineEdge<AUGMENTATION, typename TREE::NODE>(k, highest, &result));
+            return result;
+        }
+
+    public:
+        /**********************************/
+        /*         Public Section         */
+        /**********************************/
+        // Recalculates all of the summaries of node from its children. (The RANK functor)
+        template<class NODE>
+        void operator()(NODE& node, const NODE* left, const NODE* right)
+        {
+            AugmentStep<0, AUGMENTATIONS...>::update(node, left, right);
+        }
+
+        /*
+         * Method: get
+         * Usage: Ranks::get<SubtreeCount>(node);
+         * -----------------------------------
+         * Returns the summary of an augmentation for the sub tree of node.
+         * The worst time and space complexity for this method is O(1).
+         */
+        template<class AUGMENTATION, class NODE>
+        static const typename AUGMENTATION::value_type& get(const NODE& node)
+        {
+            return std::get<IndexOf<AUGMENTATION, AUGMENTATIONS...>::value>(node.val);
+        }
+
+        /*
+         * Method: highest, lowest
+         * Usage: Ranks::highest<SubtreeSum<ViewsOf>>(tree, k);
+         *        Ranks::lowest<SubtreeMax<ViewsOf>>(tree, k);
+         * -----------------------------------
+         * Returns the summary of an augmentation over the k highest (or lowest) keys in the tree.
+         * k is clamped to the size of the tree. Needs SubtreeCount to be one of the augmentations.
+         * When n is the total number of keys in the tree, the
+         * worst time and space complexity for these methods is O(log n).
+         */
+        template<class AUGMENTATION, class TREE>
+        static typename AUGMENTATION::value_type highest(const TREE& tree, int k)
+        {
+            return combineEdge<AUGMENTATION>(tree, k, true);
+        }
+
+        template<class AUGMENTATION, class TREE>
+        static typename AUGMENTATION::value_type lowest(const TREE& tree, int k)
+        {
+            return combineEdge<AUGMENTATION>(tree, k, false);
+        }
+
+        /*
+         * Method: total
+         * Usage: Ranks::total<SubtreeSum<ViewsOf>>(tree);
+         * -----------------------------------
+         * Returns the summary of an augmentation over all of the keys in the tree, which the root keeps.
+         * The worst time and space complexity for this method is O(1).
+         */
+        template<class AUGMENTATION, class TREE>
+        static typename AUGMENTATION::value_type total(const TREE& tree)
+        {
+            const typename TREE::NODE* root = tree.rank(AtRoot());
+            return root? get<AUGMENTATION>(*root) : AUGMENTATION::identity();
+        }
+
+        /*
+         * Method: nthHighest, nthLowest
+         * Usage: Ranks::nthHighest(tree, i);
+         * -----------------------------------
+         * Returns the node of the i-th highest (or lowest) key in the tree, counting from 1,
+         * or a null pointer if there is no such key. Needs SubtreeCount to be one of the augmentations.
+         * When n is the total number of keys in the tree, the
+         * worst time and space complexity for these methods is O(log n).
+         */
+        template<class TREE>
+        static const typename TREE::NODE* nthHighest(const TREE& tree, int i)
+        {
+            if(i <= 0 || i > tree.size())
+            {
+                return nullptr;
+            }
+            return tree.rank(FindNth<typename TREE::NODE>(i, true));
+        }
+
+        template<class TREE>
+        static const typename TREE::NODE* nthLowest(const TREE& tree, int i)
+        {
+            if(i <= 0 || i > tree.size())
+            {
+                return nullptr;
+            }
+            return tree.rank(FindNth<typename TREE::NODE>(i, false));
+        }
+    };
+}
+#endif
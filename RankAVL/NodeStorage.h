@@ -0,0 +1,336 @@
+#ifndef _NODE_STORAGE_H
+#define _NODE_STORAGE_H
+#include <memory>
+#include <new>
+#include <utility>
+#include <stdint.h>
+
+namespace DS
+{
+    //Declaration of a template node struct, linked with shared pointers.
+    template<typename KEY_TYPE, typename VAL_TYPE>
+    struct graph_node
+    {
+        KEY_TYPE key;
+        VAL_TYPE val;
+        int height = 0;
+        std::shared_ptr<graph_node<KEY_TYPE, VAL_TYPE>> father;
+        std::shared_ptr<graph_node<KEY_TYPE, VAL_TYPE>> left;
+        std::shared_ptr<graph_node<KEY_TYPE, VAL_TYPE>> right;
+    };
+
+    //Declaration of a template node struct, linked with 32-bit indices into a NodePool.
+    //The index 0 is reserved as the null link.
+    template<typename KEY_TYPE, typename VAL_TYPE>
+    struct pool_node
+    {
+        KEY_TYPE key;
+        VAL_TYPE val;
+        int height = 0;
+        uint32_t father = 0;
+        uint32_t left = 0;
+        uint32_t right = 0;
+    };
+
+    /*
+     * Node storage policies
+     * ---------------------------------------
+     * A storage policy decides how the nodes of an AVL tree are allocated and linked.
+     * Every policy exposes:
+     *   node_type            - The node struct (has key, val, height, father, left, right).
+     *   link                 - The type of the father/left/right fields. link() is the null link.
+     *   operator[](l)        - The node that l links to.
+     *   ptr(l)               - A raw pointer to the node that l links to, or nullptr for a null link.
+     *   allocate()           - A link to a new default constructed node.
+     *   release(l)           - Returns a node that is no longer linked to the tree.
+     *   clear(root)          - Frees every node of the tree rooted at root and nullifies root.
+     *   reserve(count)       - Prepares room for count more nodes.
+     *   swap(other)          - Exchanges the nodes of two storages.
+     *   adopt(other, root)   - Moves the sub tree rooted at root from other into this storage,
+     *                          and returns the new link to its root.
+     */
+
+    // NODE must have the fields of graph_node, with its father, left and right links of type std::shared_ptr<NODE>.
+    template<typename KEY_TYPE, typename VAL_TYPE, class NODE=graph_node<KEY_TYPE, VAL_TYPE>>
+    class SharedNodes
+    {
+    public:
+        typedef NODE node_type;
+        typedef std::shared_ptr<NODE> link;
+
+        NODE& operator[](const link& l)
+        {
+            return *l;
+        }
+
+        const NODE& operator[](const link& l) const
+        {
+            return *l;
+        }
+
+        NODE* ptr(const link& l)
+        {
+            return l.get();
+        }
+
+        const NODE* ptr(const link& l) const
+        {
+            return l.get();
+        }
+
+        link allocate()
+        {
+            return std::make_shared<NODE>();
+        }
+
+        // The node is freed once the last pointer to it is dropped.
+        void release(const link& l) { }
+
+        void reserve(int count) { }
+
+        // The nodes are not owned by the storage, so there is nothing to move.
+        void swap(SharedNodes& other) { }
+
+        link adopt(SharedNodes& other, const link& root)
+        {
+            return root;
+        }
+
+        void clear(link& root)
+        {
+            if(root)
+            {
+                clear(root->left);
+                clear(root->right);
+                root = nullptr;
+            }
+        }
+    };
+
+    // NODE must have the fields of pool_node, with its father, left and right links of type uint32_t.
+    // Released cells are chained into a free list through their left link, and reused first.
+    template<typename KEY_TYPE, typename VAL_TYPE, class NODE=pool_node<KEY_TYPE, VAL_TYPE>>
+    class NodePool
+    {
+    public:
+        typedef NODE node_type;
+        typedef uint32_t link;
+
+    private:
+        /*********************************/
+        /*        Private Section        */
+        /*********************************/
+        NODE* slab;
+        link capacity; // Number of allocated cells in the slab
+        link used; // Number of cells that were ever handed out (including the reserved cell 0)
+        link free_head; // Head of the recycled cells list, chained through their 'left' link
+
+        static const link INIT_CAPACITY = 16;
+        static const link MAX_CAPACITY = 0x80000000u;
+
+        // Reallocates the slab with twice the cells (or min_capacity if it is larger) and moves the nodes into it.
+        void grow(link min_capacity = 0)
+        {
+            if(capacity >= MAX_CAPACITY)
+            {
+                throw std::bad_alloc();
+            }
+            link new_capacity = capacity? capacity*2 : INIT_CAPACITY;
+            if(new_capacity < min_capacity)
+            {
+                new_capacity = min_capacity;
+            }
+            NODE* new_slab = new NODE[new_capacity];
+            for(link i = 0; i < capacity; i++)
+            {
+                new_slab[i] = std::move(slab[i]);
+            }
+            delete[] slab;
+            slab = new_slab;
+            capacity = new_capacity;
+        }
+
+    public:
+        /**********************************/
+        /*         Public Section         */
+        /**********************************/
+        /*
+         * Constructor: NodePool
+         * Usage: NodePool<KEY_TYPE, VAL_TYPE> pool;
+         * ---------------------------------------
+         * Creates an empty pool. The slab is allocated on the first allocate().
+         * Worst time complexity: O(1)
+         */
+        NodePool() : slab(nullptr), capacity(0), used(1), free_head(0) { }
+
+        NodePool(const NodePool& other) :
+        slab(nullptr), capacity(other.capacity), used(other.used), free_head(other.free_head)
+        {
+            if(other.slab)
+            {
+                slab = new NODE[capacity];
+                for(link i = 0; i < used; i++)
+                {
+                    slab[i] = other.slab[i];
+                }
+            }
+        }
+
+        NodePool& operator=(const NodePool& other)
+        {
+            if(this == &other)
+            {
+                return *this;
+            }
+            NodePool copy(other);
+            swap(copy);
+            return *this;
+        }
+
+        ~NodePool()
+        {
+            delete[] slab;
+        }
+
+        NODE& operator[](link l)
+        {
+            return slab[l];
+        }
+
+        const NODE& operator[](link l) const
+        {
+            return slab[l];
+        }
+
+        NODE* ptr(link l)
+        {
+            return l? slab + l : nullptr;
+        }
+
+        const NODE* ptr(link l) const
+        {
+            return l? slab + l : nullptr;
+        }
+
+        /*
+         * Method: allocate
+         * Usage: pool.allocate();
+         * -----------------------------------
+         * Returns the index of a default constructed node, recycling released cells first.
+         * May move the slab, so references and pointers to nodes are invalidated.
+         * Amortized time complexity: O(1)
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        link allocate()
+        {
+            if(free_head)
+            {
+                link l = free_head;
+                free_head = slab[l].left;
+                slab[l].left = 0;
+                return l;
+            }
+            if(used >= capacity)
+            {
+                grow();
+            }
+            return used++;
+        }
+
+        /*
+         * Method: release
+         * Usage: pool.release(l);
+         * -----------------------------------
+         * Resets the node and pushes its cell to the free list.
+         * Worst time complexity: O(1)
+         */
+        void release(link l)
+        {
+            slab[l] = NODE();
+            slab[l].left = free_head;
+            free_head = l;
+        }
+
+        /*
+         * Method: reserve
+         * Usage: pool.reserve(count);
+         * -----------------------------------
+         * Makes sure the next count allocations will not move the slab.
+         * Worst time complexity: O(capacity)
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        void reserve(int count)
+        {
+            if(count <= 0 || static_cast<uint64_t>(used) + count <= capacity)
+            {
+                return;
+            }
+            if(static_cast<uint64_t>(used) + count > MAX_CAPACITY)
+            {
+                throw std::bad_alloc();
+            }
+            grow(used + count);
+        }
+
+        void swap(NodePool& other)
+        {
+            std::swap(slab, other.slab);
+            std::swap(capacity, other.capacity);
+            std::swap(used, other.used);
+            std::swap(free_head, other.free_head);
+        }
+
+        /*
+         * Method: adopt
+         * Usage: pool.adopt(other, root);
+         * -----------------------------------
+         * Moves the nodes of the sub tree rooted at root from other into this pool,
+         * and returns the index of the moved root. The moved root has no father.
+         * When m is the number of nodes in the sub tree, the
+         * worst time complexity for this method is O(m).
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        link adopt(NodePool& other, link root)
+        {
+            if(!root || &other == this)
+            {
+                return root;
+            }
+            link moved = allocate();
+            slab[moved] = std::move(other.slab[root]);
+            slab[moved].father = 0;
+            link left = adopt(other, slab[moved].left);
+            link right = adopt(other, slab[moved].right);
+            slab[moved].left = left;
+            slab[moved].right = right;
+            if(left)
+            {
+                slab[left].father = moved;
+            }
+            if(right)
+            {
+                slab[right].father = moved;
+            }
+            other.release(root);
+            return moved;
+        }
+
+        // The pool holds a single tree, so the whole slab is dropped.
+        void clear(link& root)
+        {
+            delete[] slab;
+            slab = nullptr;
+            capacity = 0;
+            used = 1;
+            free_head = 0;
+            root = 0;
+        }
+    };
+}
+#endif
@@ -0,0 +1,528 @@
+#ifndef _PERSISTENT_RANK_AVL_T
+#define _PERSISTENT_RANK_AVL_T
+#include <atomic>
+#include <memory>
+#include <assert.h>
+#include "RankAVL.h"
+#include "../Exceptions/Exceptions.h"
+
+namespace DS
+{
+    //Declaration of a template node struct for persistent trees.
+    //The nodes have no father links, so a node can be shared by several versions of a tree.
+    template<typename KEY_TYPE, typename VAL_TYPE>
+    struct persistent_node
+    {
+        KEY_TYPE key;
+        VAL_TYPE val;
+        int height = 0;
+        std::shared_ptr<persistent_node<KEY_TYPE, VAL_TYPE>> left;
+        std::shared_ptr<persistent_node<KEY_TYPE, VAL_TYPE>> right;
+    };
+
+    /*
+     * Class: RankSnapshot
+     * ---------------------------------------
+     * A read only version of a PersistentRankAVL. The version stays the same while the tree
+     * it was taken from keeps changing, and its nodes are freed when the last version that uses them is gone.
+     * Readers only follow raw pointers, so a snapshot may be read by one thread while another writes to the tree,
+     * as long as every version is only used by one thread at a time. (a version may be handed to another thread)
+     */
+    template<typename KEY_TYPE=int, typename VAL_TYPE=int>
+    class RankSnapshot
+    {
+    public:
+        typedef persistent_node<KEY_TYPE, VAL_TYPE> NODE;
+        typedef std::shared_ptr<NODE> link;
+
+        /*********************************/
+        /*       Protected Section       */
+        /*********************************/
+    protected:
+        link tree_root;
+        int node_count;
+
+        // The height of an AVL tree with 2^32 nodes is below 47, so the search paths fit in a fixed stack.
+        static const int MAX_DEPTH = 64;
+
+        // Finds the node that holds key, or a null pointer if there is none.
+        const NODE* findNode(const KEY_TYPE& key) const
+        {
+            const NODE* node = tree_root.get();
+            while(node && node->key != key)
+            {
+                node = (key > node->key)? node->right.get() : node->left.get();
+            }
+            return node;
+        }
+
+        /**********************************/
+        /*         Public Section         */
+        /**********************************/
+    public:
+        /*
+         * Constructor: RankSnapshot
+         * Usage: RankSnapshot<KEY_TYPE, VAL_TYPE> version;
+         *        RankSnapshot<KEY_TYPE, VAL_TYPE> version = tree.snapshot();
+         * ---------------------------------------
+         * Create an empty version, or take a version of a tree with the second syntax.
+         * Copying a version shares its nodes.
+         * Worst time complexity: O(1)
+         */
+        RankSnapshot() : tree_root(), node_count(0) { }
+
+        /*
+         * Method: find
+         * Usage: version.find(key);
+         * -----------------------------------
+         * Checks if the key exists in the version.
+         * If the key was found, return true. Return false otherwise.
+         * When n is the total number of keys in the version, the
+         * worst time and space complexity for this method is O(log n).
+         */
+        bool find(const KEY_TYPE& key) const noexcept
+        {
+            return findNode(key) != nullptr;
+        }
+
+        /*
+         * Method: at
+         * Usage: version.at(key);
+         * -----------------------------------
+         * Finds the key and returns the value it is mapped to.
+         * If the key wasn't found, throws a KeyNotFound exception.
+         * When n is the total number of keys in the version, the
+         * worst time and space complexity for this method is O(log n).
+         *
+         * Possible Exceptions:
+         * KeyNotFound.
+         */
+        const VAL_TYPE& at(const KEY_TYPE& key) const
+        {
+            const NODE* node = findNode(key);
+            if(!node)
+            {
+                throw KeyNotFound();
+            }
+            return node->val;
+        }
+
+        /*
+         * Method: getLowest, getHighest
+         * Usage: version.getLowest();
+         * -----------------------------------
+         * Returns the node of the lowest (or highest) key in the version,
+         * In the case that the version is empty, return a null pointer.
+         * When n is the total number of keys in the version, the
+         * worst time and space complexity for these methods is O(log n).
+         */
+        const NODE* getLowest() const
+        {
+            const NODE* node = tree_root.get();
+            while(node && node->left)
+            {
+                node = node->left.get();
+            }
+            return node;
+        }
+
+        const NODE* getHighest() const
+        {
+            const NODE* node = tree_root.get();
+            while(node && node->right)
+            {
+                node = node->right.get();
+            }
+            return node;
+        }
+
+        /*
+         * Method: inOrder
+         * Usage: version.inOrder(functor);
+         *        version.inOrder(functor, k);
+         * -----------------------------------
+         * Applies the functor for k nodes in an in-order traversal.
+         * The functor is called as func(const NODE& node, int* k),
+         * and must decrease k for the number of nodes it has taken care of.
+         * Input a negative number for k or do not input it to get a full traversal.
+         * The traversal keeps the path to the current node in a fixed stack, so it does not recurse.
+         * When n is the total number of keys in the version, the
+         * worst time complexity for this method is O(n * O(func)), and the space complexity is O(1).
+         */
+        template<class FUNCTOR>
+        void inOrder(FUNCTOR& func, int k = -1) const
+        {
+            if(k < 0)
+            {
+                k = node_count;
+            }
+            const NODE* path[MAX_DEPTH];
+            int depth = 0;
+            const NODE* current = tree_root.get();
+            while((current || depth > 0) && k != 0)
+            {
+                if(current)
+                {
+                    assert(depth < MAX_DEPTH);
+                    path[depth++] = current;
+                    current = current->left.get();
+                    continue;
+                }
+                current = path[--depth];
+                func(*current, &k);
+                current = current->right.get();
+            }
+        }
+
+        /*
+         * Method: reverseInOrder
+         * Usage: version.reverseInOrder(functor);
+         *        version.reverseInOrder(functor, k);
+         * -----------------------------------
+         * Applies the functor for k nodes in a reverse in-order traversal.
+         * The functor is called as func(const NODE& node).
+         * Input a negative number for k or do not input it to get a full traversal.
+         * When n is the total number of keys in the version, the
+         * worst time complexity for this method is O(n * O(func)), and the space complexity is O(1).
+         */
+        template<class FUNCTOR>
+        void reverseInOrder(FUNCTOR& func, int k = -1) const
+        {
+            if(k < 0)
+            {
+                k = node_count;
+            }
+            const NODE* path[MAX_DEPTH];
+            int depth = 0;
+            const NODE* current = tree_root.get();
+            while((current || depth > 0) && k != 0)
+            {
+                if(current)
+                {
+                    assert(depth < MAX_DEPTH);
+                    path[depth++] = current;
+                    current = current->right.get();
+                    continue;
+                }
+                current = path[--depth];
+                func(*current);
+                k--;
+                current = current->left.get();
+            }
+        }
+
+        /*
+         * Method: rank
+         * Usage: version.rank(calc_functor);
+         * -----------------------------------
+         * Call the calc_functor for each step in the search path, the same as RankAVL::rank.
+         * The functor is called as:
+         *     SearchPath operator()(const NODE& node, const NODE* left, const NODE* right);
+         * The nodes have no father links, so the search keeps the path it took to step back to the parent.
+         * Returns a pointer to the node the search ended at, or a null pointer if
+         * the search stepped out of the version.
+         * When n is the total number of keys in the version, the
+         * worst time and space complexity for this method is O(log n).
+         */
+        template<class FUNCTOR>
+        const NODE* rank(FUNCTOR calc_functor) const
+        {
+            const NODE* path[MAX_DEPTH];
+            int depth = 0;
+            const NODE* current = tree_root.get();
+            while(current)
+            {
+                SearchPath curr_step = calc_functor(*current, current->left.get(), current->right.get());
+                switch(curr_step)
+                {
+                case SearchPath::left:
+                    assert(depth < MAX_DEPTH);
+                    path[depth++] = current;
+                    current = current->left.get();
+                    break;
+                case SearchPath::right:
+                    assert(depth < MAX_DEPTH);
+                    path[depth++] = current;
+                    current = current->right.get();
+                    break;
+                case SearchPath::parent:
+                    current = depth? path[--depth] : nullptr;
+                    break;
+                case SearchPath::end:
+                    return current;
+                default:
+                    break;
+                }
+            }
+            return current;
+        }
+
+        /*
+         * Method: size
+         * Usage: version.size();
+         * -----------------------------------
+         * Returns the number of nodes in the version,
+         *
+         * The worst time and space complexity for this method is O(1).
+         */
+        int size() const
+        {
+            return node_count;
+        }
+    };
+
+    /*
+     * Class: PersistentRankAVL
+     * ---------------------------------------
+     * A Rank AVL tree that keeps its old versions (path copying).
+     * snapshot() takes a read only version in O(1). After that, every update copies only the
+     * O(log n) nodes on its search path that are shared with a version, and changes the
+     * nodes that are not shared in place, so the tree costs nothing extra while there are no snapshots.
+     * Copying the tree is O(1) as well, and the copies are independent.
+     * RANK is the same functor as in RankAVL:
+     *     void operator()(NODE& node, const NODE* left, const NODE* right);
+     */
+    template<typename RANK, typename KEY_TYPE=int, typename VAL_TYPE=int>
+    class PersistentRankAVL : public RankSnapshot<KEY_TYPE, VAL_TYPE>
+    {
+        typedef RankSnapshot<KEY_TYPE, VAL_TYPE> Version;
+    public:
+        typedef typename Version::NODE NODE;
+        typedef typename Version::link link;
+
+    private:
+        /*********************************/
+        /*        Private Section        */
+        /*********************************/
+        RANK rankUpdate;
+
+        /*   Class Private Methods   */
+        // Return the higher value out of two integers
+        static int max(int a, int b)
+        {
+            return (a > b)? a : b;
+        }
+
+        // Return the height of node.
+        static int height(const link& node)
+        {
+            return node? node->height : -1;
+        }
+
+        static int getBalance(const link& node)
+        {
+            return height(node->left) - height(node->right);
+        }
+
+        // Makes sure no other version uses node, by copying it if it is shared. (copy-on-write)
+        // The copy shares the children of node, so they are copied in turn if they are changed later.
+        // use_count is a relaxed load. Once it reads 1, the acquire fence pairs it with the release of the last
+        // other reference, so the reads of the thread that dropped that version happen before node is changed here.
+        static void own(link& node)
+        {
+            if(node.use_count() > 1)
+            {
+                node = std::make_shared<NODE>(*node);
+            }
+            else
+            {
+                std::atomic_thread_fence(std::memory_order_acquire);
+            }
+        }
+
+        // Recalculates the height and rank of an owned node from its children.
+        void update(const link& node)
+        {
+            node->height = max(height(node->left), height(node->right)) + 1;
+            rankUpdate(*node, node->left.get(), node->right.get());
+        }
+
+        // General right and left rotations for balanced trees. sub_root must be owned, and is set to the new root.
+        void rotateRight(link& sub_root)
+        {
+            own(sub_root->left);
+            link L_sub = sub_root->left;
+            sub_root->left = L_sub->right;
+            update(sub_root);
+            L_sub->right = sub_root;
+            update(L_sub);
+            sub_root = L_sub;
+        }
+
+        void rotateLeft(link& sub_root)
+        {
+            own(sub_root->right);
+            link R_sub = sub_root->right;
+            sub_root->right = R_sub->left;
+            update(sub_root);
+            R_sub->left = sub_root;
+            update(R_sub);
+            sub_root = R_sub;
+        }
+
+        // Updates an owned root after one of its sub trees has changed, and rebalances it.
+        void rebalance(link& root)
+        {
+            update(root);
+            int balance_fact = getBalance(root);
+            if(balance_fact > 1)
+            {
+                if(getBalance(root->left) < 0) // LR rotation
+                {
+                    own(root->left);
+                    rotateLeft(root->left);
+                }
+                rotateRight(root); // LL rotation
+            }
+            else if(balance_fact < -1)
+            {
+                if(getBalance(root->right) > 0) // RL rotation
+                {
+                    own(root->right);
+                    rotateRight(root->right);
+                }
+                rotateLeft(root); // RR rotation
+            }
+        }
+
+        // An auxiliary insert method. Returns true if a new node was added.
+        bool insertAux(link& root, const KEY_TYPE& key, const VAL_TYPE& val)
+        {
+            if(!root)
+            {
+                root = std::make_shared<NODE>();
+                root->key = key;
+                root->val = val;
+                update(root);
+                return true;
+            }
+            own(root);
+            bool added;
+            if(root->key > key)
+            {
+                added = insertAux(root->left, key, val);
+            }
+            else if(root->key < key)
+            {
+                added = insertAux(root->right, key, val);
+            }
+            else //There already exists a node with the same key, so overwrite it's contents.
+            {
+                root->val = val;
+                update(root);
+                return false;
+            }
+            rebalance(root);
+            return added;
+        }
+
+        // Unlinks the node of the lowest key in the sub tree of root, and copies its contents to target.
+        void takeLowest(link& root, NODE& target)
+        {
+            own(root);
+            if(root->left)
+            {
+                takeLowest(root->left, target);
+                rebalance(root);
+                return;
+            }
+            target.key = root->key;
+            target.val = root->val;
+            root = root->right;
+        }
+
+        // An auxiliary erase method. key must be in the sub tree of root.
+        void eraseAux(link& root, const KEY_TYPE& key)
+        {
+            assert(root);
+            if(root->key == key && (!root->left || !root->right))
+            {
+                // The only child (or nothing) takes the place of root:
+                root = root->left? root->left : root->right;
+                return;
+            }
+            own(root);
+            if(root->key > key)
+            {
+                eraseAux(root->left, key);
+            }
+            else if(root->key < key)
+            {
+                eraseAux(root->right, key);
+            }
+            else
+            {
+                takeLowest(root->right, *root); // The successor takes the place of root
+            }
+            rebalance(root);
+        }
+
+    public:
+        /**********************************/
+        /*         Public Section         */
+        /**********************************/
+        /*
+         * Constructor: PersistentRankAVL
+         * Usage: PersistentRankAVL<RANK, KEY_TYPE, VAL_TYPE> tree(rankUpdate);
+         * ---------------------------------------
+         * Create an empty persistent Rank AVL tree.
+         * Worst time complexity: O(1)
+         */
+        explicit PersistentRankAVL(RANK func) : Version(), rankUpdate(func) { }
+
+        /*
+         * Method: insert
+         * Usage: tree.insert(key, val);
+         * -----------------------------------
+         * Inserts the pair (key, val) to the tree.
+         * Only the nodes on the search path that are shared with a snapshot are copied.
+         * When n is the total number of keys in the tree, the
+         * worst time and space complexity for this method is O(log n).
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        void insert(const KEY_TYPE& key, const VAL_TYPE& val)
+        {
+            if(insertAux(Version::tree_root, key, val))
+            {
+                Version::node_count++;
+            }
+        }
+
+        /*
+         * Method: erase
+         * Usage: tree.erase(key);
+         * -----------------------------------
+         * Erases the pair corresponding to 'key' from the tree.
+         * Only the nodes on the search path that are shared with a snapshot are copied.
+         * When n is the total number of keys in the tree, the
+         * worst time and space complexity for this method is O(log n).
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        void erase(const KEY_TYPE& key)
+        {
+            if(!Version::findNode(key)) // Nothing changes, so nothing should be copied
+            {
+                return;
+            }
+            eraseAux(Version::tree_root, key);
+            Version::node_count--;
+        }
+
+        /*
+         * Method: snapshot
+         * Usage: RankSnapshot<KEY_TYPE, VAL_TYPE> version = tree.snapshot();
+         * -----------------------------------
+         * Returns a read only version of the tree as it is now.
+         * The worst time and space complexity for this method is O(1).
+         */
+        Version snapshot() const
+        {
+            return Version(*this);
+        }
+    };
+}
+#endif
@@ -1,6 +1,7 @@
 #ifndef _RANK_AVL_T
 #define _RANK_AVL_T
 #include <memory>
+#include <algorithm>
 #include <assert.h>
 #include "AVL.h"
 #include "../Exceptions/Exceptions.h"
@@ -12,242 +13,583 @@ namespace DS
         start, left, right, parent, end
     };
 
-    template<typename RANK, typename KEY_TYPE=int, typename VAL_TYPE=int, class NODE=graph_node<KEY_TYPE, VAL_TYPE>> 
-    class RankAVL : public AVL<KEY_TYPE, VAL_TYPE, NODE>
+    /*
+     * RANK is a functor that recalculates the rank kept in a node's val from its children:
+     *     void operator()(NODE& node, const NODE* left, const NODE* right);
+     * where a missing child is passed as a null pointer.
+     */
+    template<typename RANK, typename KEY_TYPE=int, typename VAL_TYPE=int, class STORAGE=SharedNodes<KEY_TYPE, VAL_TYPE>>
+    class RankAVL : public AVL<KEY_TYPE, VAL_TYPE, STORAGE, RankAVL<RANK, KEY_TYPE, VAL_TYPE, STORAGE>>
     {
-        typedef AVL<KEY_TYPE, VAL_TYPE, NODE> Avl;
+        typedef AVL<KEY_TYPE, VAL_TYPE, STORAGE, RankAVL> Avl;
+        friend Avl; // The AVL calls the rank updating rotations below
+    public:
+        typedef typename Avl::NODE NODE;
+        typedef typename Avl::link link;
+
     private:
         /*********************************/
         /*        Private Section        */
         /*********************************/
         RANK rankUpdate;
 
+        // The height of an AVL tree with 2^32 nodes is below 47, so the search paths fit in a fixed stack.
+        static const int MAX_DEPTH = 64;
+
         /*   Class Private Methods   */
-        // General right and left rotations for balanced trees, return the new root of the tree.
-        std::shared_ptr<NODE> rotateRight(std::shared_ptr<NODE>& sub_root) override
+        // Recalculates the rank of a single node from its children.
+        void updateRank(const link& node)
         {
-            std::shared_ptr<NODE> father = sub_root->father;
-            std::shared_ptr<NODE> L_sub = sub_root->left;
-            std::shared_ptr<NODE> LR_sub = L_sub->right;
-
-            // Do the rotation:
-            L_sub->right = sub_root;
-            sub_root->left = LR_sub;
-            L_sub->father = father; // Update the fathers
-            sub_root->father = L_sub;
-            if(LR_sub)
-            {
-                LR_sub->father = sub_root;
-            }
+            NODE& current = Avl::nodes[node];
+            rankUpdate(current, Avl::nodes.ptr(current.left), Avl::nodes.ptr(current.right));
+        }
 
-            // Update the new heights:
-            sub_root->height = Avl::max(Avl::height(sub_root->left), Avl::height(sub_root->right)) + 1;
-            L_sub->height = Avl::max(Avl::height(L_sub->left), Avl::height(L_sub->right)) + 1;
+        // General right and left rotations for balanced trees, return the new root of the tree.
+        link rotateRight(link sub_root)
+        {
+            link L_sub = Avl::rotateRight(sub_root);
 
             // Update ranks:
-            rankUpdate(sub_root);
-            rankUpdate(L_sub);
+            updateRank(sub_root);
+            updateRank(L_sub);
 
             // Return the new sub root
             return L_sub;
         }
 
 
-        std::shared_ptr<NODE> rotateLeft(std::shared_ptr<NODE>& sub_root) override
+        link rotateLeft(link sub_root)
         {
-            std::shared_ptr<NODE> father = sub_root->father;
-            std::shared_ptr<NODE> R_sub = sub_root->right;
-            std::shared_ptr<NODE> RL_sub = R_sub->left;
-
-            // Do the rotation:
-            R_sub->left = sub_root;
-            sub_root->right = RL_sub;
-            R_sub->father = father; // Update the fathers
-            sub_root->father = R_sub;
-            if(RL_sub)
-            {
-                RL_sub->father = sub_root;
-            }
-
-            // Update the new heights:
-            sub_root->height = Avl::max(Avl::height(sub_root->left), Avl::height(sub_root->right)) + 1;
-            R_sub->height = Avl::max(Avl::height(R_sub->left), Avl::height(R_sub->right)) + 1;
+            link R_sub = Avl::rotateLeft(sub_root);
 
             // Update ranks:
-            rankUpdate(sub_root);
-            rankUpdate(R_sub);
+            updateRank(sub_root);
+            updateRank(R_sub);
 
             // Return the new sub root
             return R_sub;
         }
 
-        std::shared_ptr<NODE> insertAux(const KEY_TYPE& key, const VAL_TYPE& val, std::shared_ptr<NODE>& root) override
+        // A functor for buildSorted, calculates the ranks bottom up.
+        class FinishRank
+        {
+            RankAVL* tree;
+        public:
+            explicit FinishRank(RankAVL* tree) : tree(tree) { }
+            void operator()(const link& node)
+            {
+                tree->updateRank(node);
+            }
+        };
+
+        // Rotates an unbalanced sub tree back into balance, and returns its new root.
+        link rebalance(link root)
         {
-            assert(root != nullptr);
-            // 1. Do a normal BST rotation:
-            if(root->key > key)
+            int balance_fact = Avl::getBalance(root);
+            if (balance_fact > 1)
             {
-                if(root->left == nullptr)
+                if (Avl::getBalance(Avl::nodes[root].left) < 0) // LR rotation
                 {
-                    root->left = Avl::newNode(key, val, root);
-                    root->height = Avl::max(Avl::height(root->left), Avl::height(root->right)) + 1;
-                    rankUpdate(root->left); // Update ranks
-                    rankUpdate(root);
-                    Avl::node_count++;
-                    return root;
+                    link new_left = rotateLeft(Avl::nodes[root].left);
+                    Avl::nodes[root].left = new_left;
                 }
-                root->left = insertAux(key, val, root->left);
+                return rotateRight(root); // LL rotation
             }
-            else if(root->key < key)
+            if (balance_fact < -1)
             {
-                if(root->right == nullptr)
+                if (Avl::getBalance(Avl::nodes[root].right) > 0) // RL rotation
                 {
-                    root->right = Avl::newNode(key, val, root);
-                    root->height = Avl::max(Avl::height(root->left), Avl::height(root->right)) + 1;
-                    rankUpdate(root->right); // Update ranks
-                    rankUpdate(root);
-                    Avl::node_count++;
-                    return root;
+                    link new_right = rotateRight(Avl::nodes[root].right);
+                    Avl::nodes[root].right = new_right;
                 }
-                root->right = insertAux(key, val, root->right);
+                return rotateLeft(root); // RR rotation
+            }
+            return root;
+        }
+
+        // Points the link that held old_child (in father, or the tree root) to new_child.
+        void replaceChild(const link& father, const link& old_child, const link& new_child)
+        {
+            if(!father)
+            {
+                Avl::tree_root = new_child;
             }
-            else //There already exists a node with the same key, so overwrite it's contents.
+            else if(Avl::nodes[father].left == old_child)
             {
-                root->val = val;
-                return root;
+                Avl::nodes[father].left = new_child;
             }
+            else
+            {
+                Avl::nodes[father].right = new_child;
+            }
+        }
+
+        /*
+         * Walks the search path back up after the sub tree under path[depth - 1] has changed.
+         * Heights and balance factors are fixed only while the sub tree heights keep changing,
+         * and from there on the ranks are recalculated only while they keep changing.
+         * The walk never stops below path[replaced], a node that took a new place and whose rank is unknown.
+         */
+        void retrace(link* path, int depth, bool height_changed, int replaced = MAX_DEPTH)
+        {
+            for(int i = depth - 1; i >= 0; i--)
+            {
+                link current = path[i];
+                NODE& node = Avl::nodes[current];
+                if(!height_changed)
+                {
+                    VAL_TYPE old_rank = node.val;
+                    updateRank(current);
+                    if(node.val == old_rank && i < replaced)
+                    {
+                        return; // The ancestors' ranks are unaffected
+                    }
+                    continue;
+                }
 
-            // 2. Update the height and ranks of all the nodes in the BST search.
-            root->height = Avl::max(Avl::height(root->left), Avl::height(root->right)) + 1;
-            rankUpdate(root);
+                int old_height = node.height;
+                node.height = Avl::max(Avl::height(node.left), Avl::height(node.right)) + 1;
+                int balance_fact = Avl::getBalance(current);
+                if(balance_fact > 1 || balance_fact < -1)
+                {
+                    link sub_root = rebalance(current); // The rotations update the heights and ranks
+                    replaceChild(i? path[i - 1] : link(), current, sub_root);
+                    height_changed = (Avl::nodes[sub_root].height != old_height);
+                }
+                else
+                {
+                    updateRank(current);
+                    height_changed = (node.height != old_height);
+                }
+            }
+        }
 
-            // 3. Verify balance factors, and perform rotations if needed.
-            int balance_fact = Avl::getBalance(root);
-            // RR Rotation:
-            if((balance_fact < -1) && (root->right->key < key))
+        // Walks the tree as the calc_functor directs (see rank), and returns the node the search ended at.
+        template<class FUNCTOR>
+        link rankSearch(FUNCTOR& calc_functor) const
+        {
+            link current = Avl::tree_root;
+            while(current)
             {
-                return rotateLeft(root);
+                const NODE& node = Avl::nodes[current];
+                SearchPath curr_step = calc_functor(node, Avl::nodes.ptr(node.left), Avl::nodes.ptr(node.right));
+                switch(curr_step)
+                {
+                case SearchPath::left:
+                    current = node.left;
+                    break;
+                case SearchPath::right:
+                    current = node.right;
+                    break;
+                case SearchPath::parent:
+                    current = node.father;
+                    break;
+                case SearchPath::end:
+                    return current;
+                default:
+                    break;
+                }
             }
-            // LL Rotation:
-            if((balance_fact > 1) && (root->left->key > key))
+            return current;
+        }
+
+        // An auxiliary function for selectBatch. offset is the number of nodes before the sub tree of root.
+        template<class SIZE>
+        void selectBatchAux(SIZE& size, const link& root, const int* positions, int count, int offset, const NODE** out) const
+        {
+            if(!root || count == 0)
             {
-                return rotateRight(root);
+                return;
             }
-            // RL Rotation:
-            if((balance_fact < -1) && (root->right->key > key))
+            const NODE& node = Avl::nodes[root];
+            int position = offset + (node.left? size(Avl::nodes[node.left]) : 0) + 1;
+
+            // Split the positions between the left sub tree, this node and the right sub tree:
+            int below = std::lower_bound(positions, positions + count, position) - positions;
+            int here = std::upper_bound(positions + below, positions + count, position) - positions;
+            for(int i = below; i < here; i++)
             {
-                root->right = rotateRight(root->right);
-                return rotateLeft(root);
+                out[i] = &node;
             }
-            // LR Rotation:
-            if((balance_fact > 1) && (root->left->key < key))
+            selectBatchAux(size, node.left, positions, below, offset, out);
+            selectBatchAux(size, node.right, positions + here, count - here, position, out + here);
+        }
+
+        // Searches for key, and fills path with the nodes above it (or above the place it would be linked at).
+        // Returns the node that holds key, or a null link if there is none.
+        link findPath(const KEY_TYPE& key, link* path, int* depth) const
+        {
+            *depth = 0;
+            link current = Avl::tree_root;
+            while(current)
             {
-                root->left = rotateLeft(root->left);
-                return rotateRight(root);
+                const NODE& node = Avl::nodes[current];
+                if(node.key > key)
+                {
+                    path[(*depth)++] = current;
+                    current = node.left;
+                }
+                else if(node.key < key)
+                {
+                    path[(*depth)++] = current;
+                    current = node.right;
+                }
+                else
+                {
+                    return current;
+                }
+                assert(*depth < MAX_DEPTH);
             }
-            return root;
+            return link();
         }
 
-        // An auxiliary eraese method for the class' use.
-        std::shared_ptr<NODE> eraseAux(std::shared_ptr<NODE>& root, const KEY_TYPE& key) override
+        // Fills path with the nodes above node, from the root down, and returns their number.
+        int pathTo(const link& node, link* path) const
         {
-            // Search the node in BST
-            if (root == nullptr)
+            int depth = 0;
+            for(link father = Avl::nodes[node].father; father; father = Avl::nodes[father].father)
             {
-                return root;
+                assert(depth < MAX_DEPTH);
+                path[depth++] = father;
             }
-            if (key < root->key)
+            for(int i = 0; i < depth/2; i++)
             {
-                root->left = eraseAux(root->left, key);
+                link temp = path[i];
+                path[i] = path[depth - 1 - i];
+                path[depth - 1 - i] = temp;
             }
-            else if (key > root->key)
+            return depth;
+        }
+
+        /*
+         * Links a detached node to the tree by its key, and rebalances the tree.
+         * path and depth must be the result of findPath for the node's key.
+         */
+        void linkNode(const link& node, link* path, int depth)
+        {
+            NODE& linked = Avl::nodes[node];
+            linked.left = linked.right = link();
+            linked.height = 0;
+            updateRank(node);
+            if(depth == 0)
+            {
+                linked.father = link();
+                Avl::tree_root = node;
+                return;
+            }
+            link father = path[depth - 1];
+            linked.father = father;
+            if(Avl::nodes[father].key > linked.key)
             {
-                root->right = eraseAux(root->right, key);
+                Avl::nodes[father].left = node;
             }
-            // If root->key==key then that's the node we want to delete
             else
             {
-                // If the root has up to 1 child:
-                if(root->left == nullptr || root->right == nullptr)
+                Avl::nodes[father].right = node;
+            }
+            retrace(path, depth, true);
+        }
+
+        /*
+         * Unlinks node from the tree without freeing it, and rebalances the tree.
+         * path and depth must hold the nodes above node, from the root down. (path has to have room for MAX_DEPTH links)
+         * A node with two children is replaced by its successor, which is relinked in its place,
+         * so the links to all the other nodes stay valid.
+         */
+        void unlinkNode(const link& node, link* path, int depth)
+        {
+            NODE& removed = Avl::nodes[node];
+            link father = removed.father;
+            if(!removed.left || !removed.right)
+            {
+                // The node has up to 1 child, which takes its place:
+                link child = removed.left? removed.left : removed.right;
+                if(child)
                 {
-                    std::shared_ptr<NODE> child = root->left? root->left : root->right;
+                    Avl::nodes[child].father = father;
+                }
+                replaceChild(father, node, child);
+                retrace(path, depth, true);
+                return;
+            }
 
-                    // If there are no children at all
-                    if (child==nullptr)
-                    {
-                        root = nullptr;
-                        Avl::node_count--; // Decrement the count of nodes in the tree
-                    }
-                    // Only one child
-                    else
+            // Find the successor, and remember the path to it:
+            int replaced = depth;
+            path[depth++] = node;
+            link successor = removed.right;
+            while(Avl::nodes[successor].left)
+            {
+                assert(depth < MAX_DEPTH);
+                path[depth++] = successor;
+                successor = Avl::nodes[successor].left;
+            }
+
+            // Take the successor out of its place, it has no left child:
+            NODE& next = Avl::nodes[successor];
+            if(next.father != node)
+            {
+                link successor_father = next.father;
+                Avl::nodes[successor_father].left = next.right;
+                if(next.right)
+                {
+                    Avl::nodes[next.right].father = successor_father;
+                }
+                next.right = removed.right;
+                Avl::nodes[removed.right].father = successor;
+            }
+
+            // And put it in the place of the removed node:
+            next.left = removed.left;
+            Avl::nodes[removed.left].father = successor;
+            next.father = father;
+            next.height = removed.height;
+            replaceChild(father, node, successor);
+            path[replaced] = successor;
+            retrace(path, depth, true, replaced);
+        }
+
+        // Recalculates the ranks from node up to the root, for as long as they keep changing.
+        void refreshRanks(link node)
+        {
+            updateRank(node);
+            for(link father = Avl::nodes[node].father; father; father = Avl::nodes[father].father)
+            {
+                VAL_TYPE old_rank = Avl::nodes[father].val;
+                updateRank(father);
+                if(Avl::nodes[father].val == old_rank)
+                {
+                    return;
+                }
+            }
+        }
+
+        // Recalculates the heights and ranks from node up to the root of its sub tree,
+        // rebalancing on the way, and returns that root.
+        link fixUp(link node)
+        {
+            while(true)
+            {
+                NODE& current = Avl::nodes[node];
+                current.height = Avl::max(Avl::height(current.left), Avl::height(current.right)) + 1;
+                link father = current.father;
+                int balance_fact = Avl::getBalance(node);
+                if(balance_fact > 1 || balance_fact < -1)
+                {
+                    link sub_root = rebalance(node); // The rotations update the heights and ranks
+                    if(father)
                     {
-                        child->father = root->father;
-                        *(root) = *(child);
-                        // Update the children's father to his new address:
-                        if(child->right)
+                        if(Avl::nodes[father].left == node)
                         {
-                            child->right->father = root;
+                            Avl::nodes[father].left = sub_root;
                         }
-                        if(child->left)
+                        else
                         {
-                            child->left->father = root;
+                            Avl::nodes[father].right = sub_root;
                         }
-                        AVL<KEY_TYPE, VAL_TYPE, NODE>::node_count--; // Decrement the count of nodes in the tree
                     }
+                    node = sub_root;
                 }
-                // Two children
                 else
                 {
-                    // Find the root's replacement node:
-                    std::shared_ptr<NODE> nextMin = Avl::findLowestNode(root->right);
-                    // Backup the pointers of root before we override them
-                    std::shared_ptr<NODE> rootOldLeftChild = root->left;
-                    std::shared_ptr<NODE> rootOldRightChild = root->right;
-                    std::shared_ptr<NODE> rootOldFather = root->father;
-                    *(root) = *(nextMin); // Overwrite root with his replacement
-                    root->left = rootOldLeftChild; // Restore the original pointers
-                    root->father = rootOldFather;
-                    root->right = rootOldRightChild;
-                    root->right = eraseAux(root->right, nextMin->key);
+                    updateRank(node);
+                }
+                if(!father)
+                {
+                    return node;
                 }
+                node = father;
             }
+        }
 
-            // If a leaf was deleted:
-            if (root == nullptr)
+        // Makes left and right the children of the detached node middle.
+        void attach(const link& middle, const link& left, const link& right)
+        {
+            NODE& node = Avl::nodes[middle];
+            node.left = left;
+            node.right = right;
+            if(left)
             {
-                return root;
+                Avl::nodes[left].father = middle;
             }
-            // Update heights and ranks:
-            root->height = Avl::max(Avl::height(root->right), Avl::height(root->left)) + 1;
-            rankUpdate(root);
-            // Confirm balance factors:
-            int balance_fact = Avl::getBalance(root);
-            // If the node is unbalanced then we need two rotations according to the 4 cases:
-            if (balance_fact > 1)
+            if(right)
             {
-                if (Avl::getBalance(root->left) >= 0) // LL rotation
-                {
-                    return rotateRight(root);
-                }
-                else // LR rotation
+                Avl::nodes[right].father = middle;
+            }
+            node.height = Avl::max(Avl::height(left), Avl::height(right)) + 1;
+            updateRank(middle);
+        }
+
+        /*
+         * Joins the sub trees left and right with the detached node middle between them, and returns the new root.
+         * All keys in left must be lower than middle's key, and all keys in right higher.
+         * The roots of left and right must have no father.
+         * The time complexity is O(|height(left) - height(right)| + 1) rotations and O(log n) rank updates.
+         */
+        link joinAux(const link& left, const link& middle, const link& right)
+        {
+            int left_height = Avl::height(left);
+            int right_height = Avl::height(right);
+            if(left_height > right_height + 1)
+            {
+                // Go down the right spine of left to a sub tree that is as high as right:
+                link father = left;
+                link current = Avl::nodes[left].right;
+                while(Avl::height(current) > right_height + 1)
                 {
-                    root->left = rotateLeft(root->left);
-                    return rotateRight(root);
+                    father = current;
+                    current = Avl::nodes[current].right;
                 }
+                attach(middle, current, right);
+                Avl::nodes[father].right = middle;
+                Avl::nodes[middle].father = father;
+                return fixUp(father);
             }
-            if (balance_fact < -1)
+            if(right_height > left_height + 1)
             {
-                if (Avl::getBalance(root->right) <= 0)  //RR rotation
+                // Go down the left spine of right to a sub tree that is as high as left:
+                link father = right;
+                link current = Avl::nodes[right].left;
+                while(Avl::height(current) > left_height + 1)
                 {
-                    return rotateLeft(root);
+                    father = current;
+                    current = Avl::nodes[current].left;
                 }
-                else //RL rotation
+                attach(middle, left, current);
+                Avl::nodes[father].left = middle;
+                Avl::nodes[middle].father = father;
+                return fixUp(father);
+            }
+            attach(middle, left, right);
+            Avl::nodes[middle].father = link();
+            return middle;
+        }
+
+        /*
+         * Splits the sub tree of root into the keys lower than key (left) and the rest (right).
+         * Sets found to true if key was in the sub tree. The root of the sub tree must have no father.
+         * Every node on the search path is reused as the middle node of a join,
+         * and the heights of the joined trees telescope, so the time complexity is O(log n).
+         */
+        void splitAux(const link& root, const KEY_TYPE& key, link& left, link& right, bool& found)
+        {
+            if(!root)
+            {
+                left = right = link();
+                return;
+            }
+            NODE& node = Avl::nodes[root];
+            link sub_left = node.left;
+            link sub_right = node.right;
+            if(sub_left)
+            {
+                Avl::nodes[sub_left].father = link();
+            }
+            if(sub_right)
+            {
+                Avl::nodes[sub_right].father = link();
+            }
+            node.left = node.right = node.father = link();
+
+            if(key < node.key)
+            {
+                link middle;
+                splitAux(sub_left, key, left, middle, found);
+                right = joinAux(middle, root, sub_right);
+            }
+            else if(node.key < key)
+            {
+                link middle;
+                splitAux(sub_right, key, middle, right, found);
+                left = joinAux(sub_left, root, middle);
+            }
+            else
+            {
+                found = true;
+                left = sub_left;
+                right = joinAux(link(), root, sub_right);
+            }
+        }
+
+        // Returns the in-order successor of node inside the sub tree of root, or a null link at its end.
+        link nextInSubtree(link node, const link& root) const
+        {
+            if(Avl::nodes[node].right)
+            {
+                return Avl::findLowestNode(Avl::nodes[node].right);
+            }
+            while(node != root)
+            {
+                link father = Avl::nodes[node].father;
+                if(Avl::nodes[father].left == node)
                 {
-                    root->right = rotateRight(root->right);
-                    return rotateLeft(root);
+                    return father;
                 }
+                node = father;
             }
-            return root;
+            return link();
+        }
+
+        // Counts the nodes of two sub trees side by side, so only the smaller one is walked through entirely.
+        // total is the number of nodes in both of them.
+        void countSubtrees(const link& first, const link& second, int total, int* first_count, int* second_count) const
+        {
+            link first_node = first? Avl::findLowestNode(first) : link();
+            link second_node = second? Avl::findLowestNode(second) : link();
+            int counted = 0;
+            while(first_node && second_node)
+            {
+                counted++;
+                first_node = nextInSubtree(first_node, first);
+                second_node = nextInSubtree(second_node, second);
+            }
+            if(!first_node)
+            {
+                *first_count = counted;
+                *second_count = total - counted;
+            }
+            else
+            {
+                *second_count = counted;
+                *first_count = total - counted;
+            }
+        }
+
+        // Empties other, and splits the tree at key into the roots left and right. (see split)
+        // Returns true if key was in the tree.
+        bool splitRoots(const KEY_TYPE& key, RankAVL& other, link& left, link& right)
+        {
+            assert(this != &other);
+            other.deleteTree(other.tree_root);
+            other.setTree(link(), 0);
+
+            bool found = false;
+            splitAux(Avl::tree_root, key, left, right, found);
+            return found;
+        }
+
+        // Keeps the half of left_count nodes in the tree, and moves the half of right_count nodes into other.
+        void settleSplit(RankAVL& other, link left, link right, int left_count, int right_count)
+        {
+            if(right_count > left_count) // Keep the larger half's nodes where they are
+            {
+                Avl::nodes.swap(other.nodes);
+                left = Avl::nodes.adopt(other.nodes, left);
+            }
+            else
+            {
+                right = other.nodes.adopt(Avl::nodes, right);
+            }
+            setTree(left, left_count);
+            other.setTree(right, right_count);
+        }
+
+        // Sets the tree to hold the sub tree of root with count nodes.
+        void setTree(const link& root, int count)
+        {
+            Avl::tree_root = root;
+            Avl::node_count = count;
+            Avl::leftmost_node = root? Avl::findLowestNode(root) : link();
+            Avl::rightmost_node = root? Avl::findHighestNode(root) : link();
         }
 
     public:
@@ -256,55 +598,74 @@ namespace DS
         /**********************************/
         /*
          * Constructor: RankAVL
-         * Usage: RankAVL<RANK, KEY_TYPE, VAL_TYPE, NODE> tree(root, rankUpdate);
-         *        RankAVL<RANK, KEY_TYPE, VAL_TYPE, NODE> tree(rankUpdate);
+         * Usage: RankAVL<RANK, KEY_TYPE, VAL_TYPE, STORAGE> tree(root, rankUpdate);
+         *        RankAVL<RANK, KEY_TYPE, VAL_TYPE, STORAGE> tree(rankUpdate);
          * ---------------------------------------
          * Create an empty Rank AVL tree, or intialize it with a root using the first syntax.
          * Worst time complexity: O(1)
-         * 
+         *
          * Possible Exceptions:
          * std::bad_alloc
          */
-        explicit RankAVL(const NODE& root, RANK func) : Avl::AVL(root), Avl::rankUpdate(func) { }
+        explicit RankAVL(const NODE& root, RANK func) : Avl::AVL(root), rankUpdate(func)
+        {
+            updateRank(Avl::tree_root);
+        }
         explicit RankAVL(RANK func) : Avl::AVL(), rankUpdate(func) { }
 
-        RankAVL(const AVL<KEY_TYPE, VAL_TYPE,NODE>& other) = delete;
+        /*
+         * Constructor: RankAVL
+         * Usage: RankAVL<RANK, KEY_TYPE, VAL_TYPE, STORAGE> tree(rankUpdate, begin, end);
+         * ---------------------------------------
+         * Create a Rank AVL tree out of the keys in [begin, end), which must be sorted
+         * in ascending order and contain no duplicates. (see assignSorted)
+         * Worst time complexity: O(n)
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        template<class ITERATOR>
+        RankAVL(RANK func, ITERATOR begin, ITERATOR end) : Avl::AVL(), rankUpdate(func)
+        {
+            assignSorted(begin, end);
+        }
+
+        RankAVL(const RankAVL& other) = delete;
         RankAVL& operator=(const RankAVL& other) = delete;
-        virtual ~RankAVL() = default;
+        ~RankAVL() = default;
 
         /*
          * Method: insert
          * Usage: tree.insert(key, val);
          * -----------------------------------
-         * Inserts the pair (key, val) to the AVL Ranks tree.
+         * Inserts the pair (key, val) to the AVL Ranks tree, and returns a handle to the node it is stored in.
+         * The handle stays valid until the node is erased, and can be used with eraseNode and updateKey.
+         * The insertion is done iteratively, and the heights and ranks are only
+         * updated along the search path for as long as they keep changing.
          * When n is the total number of keys in the tree, the
          * worst time and space complexity for this method is O(log n).
-         * 
+         *
          * Possible Exceptions:
          * std::bad_alloc
          */
-        void insert(const KEY_TYPE& key, const VAL_TYPE& val) override
+        link insert(const KEY_TYPE& key, const VAL_TYPE& val)
         {
-            if(Avl::tree_root == nullptr)
+            link path[MAX_DEPTH];
+            int depth;
+            link found = findPath(key, path, &depth);
+            if(found) //There already exists a node with the same key, so overwrite it's contents.
             {
-                Avl::tree_root = Avl::newNode(key, val);
-                rankUpdate(Avl::tree_root); // Update rank
-                Avl::leftmost_node = Avl::rightmost_node = Avl::tree_root;
-                Avl::node_count++;
-                return;
-            }
-            Avl::tree_root = insertAux(key, val, Avl::tree_root);
-            
-            assert(Avl::leftmost_node);
-            assert(Avl::rightmost_node);
-            if(key < Avl::leftmost_node->key)
-            {
-                Avl::leftmost_node = Avl::findLowestNode(Avl::tree_root);
-            }
-            if(key > Avl::rightmost_node->key)
-            {
-                Avl::rightmost_node = Avl::findHighestNode(Avl::tree_root);
+                Avl::nodes[found].val = val;
+                updateRank(found); // The rank is kept in val, so recalculate it
+                retrace(path, depth, false);
+                return found;
             }
+
+            link new_node = Avl::newNode(key, val);
+            linkNode(new_node, path, depth);
+            Avl::node_count++;
+            Avl::linkEdges(new_node);
+            return new_node;
         }
 
         /*
@@ -312,50 +673,286 @@ namespace DS
          * Usage: tree.erase(key);
          * -----------------------------------
          * Erases the pair corresponding to 'key' from the AVL Rank tree.
+         * The removal is done iteratively, and the heights and ranks are only
+         * updated along the search path for as long as they keep changing.
+         * Nodes are relinked rather than copied, so the handles to other nodes stay valid,
+         * and the lowest and highest nodes are updated in O(1).
          * When n is the total number of keys in the tree, the
          * worst time and space complexity for this method is O(log n).
          */
-        void erase(const KEY_TYPE& key) override
+        void erase(const KEY_TYPE& key)
+        {
+            link path[MAX_DEPTH];
+            int depth;
+            link found = findPath(key, path, &depth);
+            if(found)
+            {
+                Avl::unlinkEdges(found);
+                unlinkNode(found, path, depth);
+                Avl::nodes.release(found);
+                Avl::node_count--; // Decrement the count of nodes in the tree
+            }
+        }
+
+        /*
+         * Method: eraseNode
+         * Usage: tree.eraseNode(handle);
+         * -----------------------------------
+         * Erases the node of a handle returned by insert, without searching for its key.
+         * When n is the total number of keys in the tree, the
+         * worst time and space complexity for this method is O(log n).
+         */
+        void eraseNode(const link& handle)
+        {
+            link path[MAX_DEPTH];
+            int depth = pathTo(handle, path);
+            Avl::unlinkEdges(handle);
+            unlinkNode(handle, path, depth);
+            Avl::nodes.release(handle);
+            Avl::node_count--; // Decrement the count of nodes in the tree
+        }
+
+        /*
+         * Method: updateKey
+         * Usage: tree.updateKey(handle, new_key);
+         * -----------------------------------
+         * Changes the key of the node of a handle returned by insert, and moves the node
+         * to its new place in the tree. The node is reused, so the handle stays valid.
+         * If the node keeps its place, only the ranks above it are recalculated.
+         * Otherwise the heights and ranks are updated along the path it left and the path it joined.
+         * If another node already holds new_key, the tree is left unchanged and KeyAlreadyExists is thrown.
+         * When n is the total number of keys in the tree, the
+         * worst time and space complexity for this method is O(log n).
+         *
+         * Possible Exceptions:
+         * KeyAlreadyExists
+         */
+        void updateKey(const link& handle, const KEY_TYPE& new_key)
         {
-            Avl::tree_root = eraseAux(Avl::tree_root, key);
-            if(Avl::tree_root)
+            link prev = Avl::prevNode(handle);
+            link next = Avl::nextNode(handle);
+            if((!prev || Avl::nodes[prev].key < new_key) && (!next || new_key < Avl::nodes[next].key))
             {
-                assert(Avl::leftmost_node);
-                assert(Avl::rightmost_node);
-                Avl::leftmost_node = Avl::findLowestNode(Avl::tree_root);
-                Avl::rightmost_node = Avl::findHighestNode(Avl::tree_root);
+                Avl::nodes[handle].key = new_key; // The order is kept, so the node stays in place
+                refreshRanks(handle);
+                return;
+            }
+
+            link path[MAX_DEPTH];
+            int depth = pathTo(handle, path);
+            Avl::unlinkEdges(handle);
+            unlinkNode(handle, path, depth);
+
+            KEY_TYPE old_key = Avl::nodes[handle].key;
+            bool exists = static_cast<bool>(findPath(new_key, path, &depth));
+            if(!exists)
+            {
+                Avl::nodes[handle].key = new_key;
             }
             else
             {
-                Avl::leftmost_node = nullptr;
-                Avl::rightmost_node = nullptr;
+                findPath(old_key, path, &depth); // Put the node back where it was
             }
+            linkNode(handle, path, depth);
+            Avl::linkEdges(handle);
+            if(exists)
+            {
+                throw KeyAlreadyExists();
+            }
+        }
+
+        /*
+         * Method: getNodeOf
+         * Usage: tree.getNodeOf(handle);
+         * -----------------------------------
+         * Returns the node of a handle returned by insert.
+         * The worst time and space complexity for this method is O(1).
+         */
+        const NODE& getNodeOf(const link& handle) const
+        {
+            return Avl::nodes[handle];
+        }
+
+        /*
+         * Method: assignSorted
+         * Usage: tree.assignSorted(begin, end);
+         * -----------------------------------
+         * Replaces the contents of the tree with the keys in [begin, end),
+         * which must be sorted in ascending order and contain no duplicates.
+         * The result is a perfectly balanced tree, and the ranks are calculated bottom up.
+         * The iterators are passed over twice, so they have to be forward iterators.
+         * When n is the number of keys in the sequence, the
+         * worst time and space complexity for this method is O(n).
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        template<class ITERATOR>
+        void assignSorted(ITERATOR begin, ITERATOR end)
+        {
+            FinishRank finish(this);
+            Avl::assignSortedAux(begin, end, finish);
+        }
+
+        /*
+         * Method: assignUnsorted
+         * Usage: tree.assignUnsorted(begin, end);
+         * -----------------------------------
+         * Same as assignSorted, but sorts the keys in [begin, end) first.
+         * Duplicate keys are only inserted once.
+         * When n is the number of keys in the sequence, the
+         * worst time complexity for this method is O(n log n) and the space complexity is O(n).
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        template<class ITERATOR>
+        void assignUnsorted(ITERATOR begin, ITERATOR end)
+        {
+            Array<KEY_TYPE> keys(Avl::countKeys(begin, end));
+            int count = Avl::sortKeys(begin, end, keys);
+            assignSorted(&keys[0], &keys[0] + count);
+        }
+
+        /*
+         * Method: join
+         * Usage: tree.join(key, val, other);
+         * -----------------------------------
+         * Moves the pair (key, val) and all the pairs of other into the tree, and leaves other empty.
+         * All the keys in the tree must be lower than key, and all the keys in other higher.
+         * The ranks are kept up to date along the joined spine.
+         * When n is the total number of keys in both trees, the
+         * worst time complexity for this method is O(log n).
+         * With a NodePool storage the nodes of the smaller tree also have to be moved
+         * into the pool of the larger one, which adds O(min(n1, n2)).
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        void join(const KEY_TYPE& key, const VAL_TYPE& val, RankAVL& other)
+        {
+            assert(this != &other);
+            assert(!Avl::rightmost_node || Avl::nodes[Avl::rightmost_node].key < key);
+            assert(!other.leftmost_node || key < other.nodes[other.leftmost_node].key);
+
+            link left = Avl::tree_root;
+            link right = other.tree_root;
+            if(other.node_count > Avl::node_count) // Keep the larger tree's nodes where they are
+            {
+                Avl::nodes.swap(other.nodes);
+                left = Avl::nodes.adopt(other.nodes, left);
+            }
+            else
+            {
+                right = Avl::nodes.adopt(other.nodes, right);
+            }
+            int count = Avl::node_count + other.node_count + 1;
+            other.setTree(link(), 0); // The nodes were already taken, so the tree is only reset
+            link empty;
+            other.nodes.clear(empty);
+
+            link middle = Avl::newNode(key, val);
+            setTree(joinAux(left, middle, right), count);
+        }
+
+        /*
+         * Method: split
+         * Usage: tree.split(key, other);
+         *        tree.split(key, other, size);
+         * -----------------------------------
+         * Keeps the pairs with keys lower than key in the tree, and moves the rest
+         * (including key itself) into other, replacing its previous contents.
+         * Returns true if key was in the tree.
+         * The ranks of both trees are kept up to date.
+         * size is called as int size(const NODE& node), and returns the number of nodes in the sub tree of node,
+         * which the RANK functor has to keep. With it, the halves are counted at their roots.
+         * When n is the number of keys in the tree, the worst time complexity
+         * for this method is O(log n) with size, or O(log n + min(n1, n2)) without it, where n1 and n2
+         * are the sizes of the halves. (The smaller half is walked through to count the nodes of each tree)
+         * With a NodePool storage the smaller half is also moved to the other pool, which adds O(min(n1, n2)).
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        bool split(const KEY_TYPE& key, RankAVL& other)
+        {
+            link left, right;
+            bool found = splitRoots(key, other, left, right);
+            int left_count, right_count;
+            countSubtrees(left, right, Avl::node_count, &left_count, &right_count);
+            settleSplit(other, left, right, left_count, right_count);
+            return found;
+        }
+
+        template<class SIZE>
+        bool split(const KEY_TYPE& key, RankAVL& other, SIZE size)
+        {
+            link left, right;
+            bool found = splitRoots(key, other, left, right);
+            int left_count = left? size(Avl::nodes[left]) : 0;
+            settleSplit(other, left, right, left_count, Avl::node_count - left_count);
+            return found;
         }
 
         /*
          * Method: rank
-         * Usage: tree.rank(key, calc_functor);
+         * Usage: tree.rank(calc_functor);
          * -----------------------------------
          * Call the calc_functor for each step in the search path to allow
          * the user to calculate the rank of the corresponding key.
-         * Checks if the key exists in the tree.
-         * If the key was found, return true.
-         * Otherwise, the rank calculated will match all keys that are less significant
-         * than the provided key using the calc_functor, and return false.
+         * The functor is called as:
+         *     SearchPath operator()(const NODE& node, const NODE* left, const NODE* right);
+         * and returns the next step of the search (left, right or parent), or end
+         * when the current node is the wanted one.
+         * Returns a pointer to the node the search ended at, or a null pointer if
+         * the search stepped out of the tree.
          * When n is the total number of keys in the tree, the
          * worst time and space complexity for this method is O(log n).
          */
         template<class FUNCTOR>
-        std::shared_ptr<NODE> rank(FUNCTOR calc_functor) const
+        const NODE* rank(FUNCTOR calc_functor) const
         {
-            SearchPath curr_step = SearchPath::start;
-            std::shared_ptr<NODE> current = Avl::tree_root;
-            while(curr_step != SearchPath::end)
+            return Avl::nodes.ptr(rankSearch(calc_functor));
+        }
+
+        /*
+         * Method: rankIterator
+         * Usage: tree.rankIterator(calc_functor);
+         * -----------------------------------
+         * Same as rank, but returns an iterator to the node the search ended at (or end()),
+         * so the nodes around it can be walked in order. (select-then-walk)
+         * Reading k nodes from there takes O(k) more.
+         * When n is the total number of keys in the tree, the
+         * worst time and space complexity for this method is O(log n).
+         */
+        template<class FUNCTOR>
+        typename Avl::const_iterator rankIterator(FUNCTOR calc_functor) const
+        {
+            return Avl::iteratorAt(rankSearch(calc_functor));
+        }
+
+        /*
+         * Method: selectBatch
+         * Usage: tree.selectBatch(size, positions, count, out);
+         * -----------------------------------
+         * Finds the nodes at several in-order positions (1 for the lowest key) in one traversal,
+         * and sets out[i] to the node at positions[i], or to a null pointer if the position is out of range.
+         * The positions must be sorted in ascending order. (repeats are allowed)
+         * size is called as int size(const NODE& node), and returns the number of nodes in the sub tree of node,
+         * which the RANK functor has to keep.
+         * The positions are split between the sub trees at every node, so every node is visited at most once.
+         * When n is the total number of keys in the tree, the worst time complexity
+         * for this method is O(k + k*log(n/k)) calls to size, and O(log n) space.
+         */
+        template<class SIZE>
+        void selectBatch(SIZE size, const int* positions, int count, const NODE** out) const
+        {
+            for(int i = 0; i < count; i++)
             {
-                curr_step = calc_functor(current);
+                out[i] = nullptr;
             }
-            return current;
+            selectBatchAux(size, Avl::tree_root, positions, count, 0, out);
         }
     };
 }
-#endif
\ No newline at end of file
+#endif
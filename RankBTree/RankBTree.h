@@ -0,0 +1,754 @@
+#ifndef _RANK_BTREE_H
+#define _RANK_BTREE_H
+#include <stdint.h>
+#include <algorithm>
+#include <iterator>
+#include <assert.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace DS
+{
+    /*
+     * Class: RankBTree
+     * ---------------------------------------
+     * An order statistics B+ tree. The keys are kept sorted in wide leaves that are linked to each other,
+     * and every inner node keeps, next to each child, the number of keys under it.
+     * Selecting the i-th key and counting the keys below a key both go down one path of about
+     * log(n)/log(FANOUT) nodes, so the tree takes far fewer cache misses than a binary rank tree.
+     * The child to go down to in a select is found with an SSE2 prefix sum over the child counts,
+     * (a scalar loop when SSE2 is not available).
+     * KEY_TYPE must have operator<.
+     */
+    template<typename KEY_TYPE, int FANOUT=32, int LEAF_SIZE=32>
+    class RankBTree
+    {
+        static_assert(FANOUT >= 4 && FANOUT % 4 == 0, "FANOUT must be a multiple of 4");
+        static_assert(LEAF_SIZE >= 4, "LEAF_SIZE must be at least 4");
+
+        /*********************************/
+        /*        Private Section        */
+        /*********************************/
+        struct Node
+        {
+            bool is_leaf;
+            int count; // The number of keys in a leaf, or children in an inner node
+        };
+
+        struct Leaf : public Node
+        {
+            KEY_TYPE keys[LEAF_SIZE];
+            Leaf* prev;
+            Leaf* next;
+
+            Leaf() : prev(nullptr), next(nullptr)
+            {
+                this->is_leaf = true;
+                this->count = 0;
+            }
+        };
+
+        // keys[i] is a lower bound for the keys under children[i]. (keys[0] only bounds the node itself)
+        // The sizes past count are kept at 0, so they can be summed in whole vectors.
+        struct Inner : public Node
+        {
+            alignas(16) int32_t sizes[FANOUT];
+            KEY_TYPE keys[FANOUT];
+            Node* children[FANOUT];
+
+            Inner()
+            {
+                this->is_leaf = false;
+                this->count = 0;
+                std::fill(sizes, sizes + FANOUT, 0);
+            }
+        };
+
+        static const int MIN_LEAF = LEAF_SIZE/2;
+        static const int MIN_INNER = FANOUT/2;
+
+        Node* root;
+        Leaf* first_leaf;
+        Leaf* last_leaf;
+        int node_count;
+
+        /*   Class Private Methods   */
+        // Returns the sum of the sizes of the first index children of node.
+        static int sumBefore(const Inner* node, int index)
+        {
+            int sum = 0;
+            int base = 0;
+#ifdef __SSE2__
+            __m128i sums = _mm_setzero_si128();
+            for(; base + 4 <= index; base += 4)
+            {
+                sums = _mm_add_epi32(sums, _mm_loadu_si128(reinterpret_cast<const __m128i*>(node->sizes + base)));
+            }
+            sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, 0x4E));
+            sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, 0xB1));
+            sum = _mm_cvtsi128_si32(sums);
+#endif
+            for(; base < index; base++)
+            {
+                sum += node->sizes[base];
+            }
+            return sum;
+        }
+
+        static int sizeOf(const Node* node)
+        {
+            return node->is_leaf? node->count : sumBefore(static_cast<const Inner*>(node), node->count);
+        }
+
+        // Returns the child that holds the key at 0-based *position in the sub tree of node,
+        // and sets *position to the position of the key in that child.
+        static int selectChild(const Inner* node, int* position)
+        {
+#ifdef __SSE2__
+            // Find the first child whose running (inclusive) prefix sum passes position, 4 children at a time:
+            const __m128i target = _mm_set1_epi32(*position);
+            __m128i carry = _mm_setzero_si128();
+            for(int base = 0; base < node->count; base += 4)
+            {
+                __m128i prefix = _mm_loadu_si128(reinterpret_cast<const __m128i*>(node->sizes + base));
+                prefix = _mm_add_epi32(prefix, _mm_slli_si128(prefix, 4));
+                prefix = _mm_add_epi32(prefix, _mm_slli_si128(prefix, 8));
+                prefix = _mm_add_epi32(prefix, carry);
+                int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(prefix, target)));
+                if(mask)
+                {
+                    int lane = 0;
+                    while(!(mask & (1 << lane)))
+                    {
+                        lane++;
+                    }
+                    int32_t sums[4];
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(sums), prefix);
+                    *position -= sums[lane] - node->sizes[base + lane];
+                    return base + lane;
+                }
+                carry = _mm_shuffle_epi32(prefix, 0xFF);
+            }
+#else
+            for(int i = 0; i < node->count; i++)
+            {
+                if(*position < node->sizes[i])
+                {
+                    return i;
+                }
+                *position -= node->sizes[i];
+            }
+#endif
+            assert(false);
+            return node->count - 1;
+        }
+
+        // Returns the child of node that key belongs to.
+        static int findChild(const Inner* node, const KEY_TYPE& key)
+        {
+            return int(std::upper_bound(node->keys + 1, node->keys + node->count, key) - node->keys) - 1;
+        }
+
+        // Returns the place of key in leaf, or the place it should be inserted at.
+        static int findKey(const Leaf* leaf, const KEY_TYPE& key)
+        {
+            return int(std::lower_bound(leaf->keys, leaf->keys + leaf->count, key) - leaf->keys);
+        }
+
+        static void deleteTree(Node* node)
+        {
+            if(node->is_leaf)
+            {
+                delete static_cast<Leaf*>(node);
+                return;
+            }
+            Inner* inner = static_cast<Inner*>(node);
+            for(int i = 0; i < inner->count; i++)
+            {
+                deleteTree(inner->children[i]);
+            }
+            delete inner;
+        }
+
+        // Adds child (with its lowest key bound and size) to node at index.
+        // If node is full, it is split first, and *split is set to its new right half.
+        static void insertChild(Inner* node, int index, Node* child, const KEY_TYPE& key, int size,
+                                Node** split, KEY_TYPE* split_key)
+        {
+            if(node->count == FANOUT)
+            {
+                Inner* right = new Inner();
+                int half = FANOUT/2;
+                right->count = FANOUT - half;
+                std::copy(node->keys + half, node->keys + FANOUT, right->keys);
+                std::copy(node->children + half, node->children + FANOUT, right->children);
+                std::copy(node->sizes + half, node->sizes + FANOUT, right->sizes);
+                std::fill(node->sizes + half, node->sizes + FANOUT, 0);
+                node->count = half;
+                *split = right;
+                *split_key = right->keys[0];
+                if(index > half)
+                {
+                    node = right;
+                    index -= half;
+                }
+            }
+            std::copy_backward(node->keys + index, node->keys + node->count, node->keys + node->count + 1);
+            std::copy_backward(node->children + index, node->children + node->count, node->children + node->count + 1);
+            std::copy_backward(node->sizes + index, node->sizes + node->count, node->sizes + node->count + 1);
+            node->keys[index] = key;
+            node->children[index] = child;
+            node->sizes[index] = size;
+            node->count++;
+        }
+
+        // Removes the child at index from node. (the child itself is not freed)
+        static void removeChild(Inner* node, int index)
+        {
+            std::copy(node->keys + index + 1, node->keys + node->count, node->keys + index);
+            std::copy(node->children + index + 1, node->children + node->count, node->children + index);
+            std::copy(node->sizes + index + 1, node->sizes + node->count, node->sizes + index);
+            node->count--;
+            node->sizes[node->count] = 0;
+        }
+
+        // An auxiliary insert method. Returns true if key was added.
+        // If node was split, sets *split to its new right half, and *split_key to a lower bound of that half.
+        bool insertAux(Node* node, const KEY_TYPE& key, Node** split, KEY_TYPE* split_key)
+        {
+            *split = nullptr;
+            if(node->is_leaf)
+            {
+                Leaf* leaf = static_cast<Leaf*>(node);
+                int place = findKey(leaf, key);
+                if(place < leaf->count && !(key < leaf->keys[place]))
+                {
+                    return false; // The key is already in the tree
+                }
+                if(leaf->count == LEAF_SIZE)
+                {
+                    Leaf* right = new Leaf();
+                    int half = LEAF_SIZE/2;
+                    right->count = LEAF_SIZE - half;
+                    std::copy(leaf->keys + half, leaf->keys + LEAF_SIZE, right->keys);
+                    leaf->count = half;
+                    right->prev = leaf;
+                    right->next = leaf->next;
+                    if(leaf->next)
+                    {
+                        leaf->next->prev = right;
+                    }
+                    else
+                    {
+                        last_leaf = right;
+                    }
+                    leaf->next = right;
+                    *split = right;
+                    if(place > half)
+                    {
+                        leaf = right;
+                        place -= half;
+                    }
+                }
+                std::copy_backward(leaf->keys + place, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+                leaf->keys[place] = key;
+                leaf->count++;
+                if(*split)
+                {
+                    *split_key = static_cast<Leaf*>(*split)->keys[0];
+                }
+                return true;
+            }
+
+            Inner* inner = static_cast<Inner*>(node);
+            int index = findChild(inner, key);
+            Node* child_split;
+            KEY_TYPE child_key;
+            if(!insertAux(inner->children[index], key, &child_split, &child_key))
+            {
+                return false;
+            }
+            inner->sizes[index]++;
+            if(child_split)
+            {
+                int right_size = sizeOf(child_split);
+                inner->sizes[index] -= right_size;
+                insertChild(inner, index + 1, child_split, child_key, right_size, split, split_key);
+            }
+            return true;
+        }
+
+        // Moves one key (or child) from the left sibling of the child at index to it.
+        void borrowFromLeft(Inner* parent, int index)
+        {
+            Node* left = parent->children[index - 1];
+            Node* right = parent->children[index];
+            if(right->is_leaf)
+            {
+                Leaf* from = static_cast<Leaf*>(left);
+                Leaf* to = static_cast<Leaf*>(right);
+                std::copy_backward(to->keys, to->keys + to->count, to->keys + to->count + 1);
+                to->keys[0] = from->keys[--from->count];
+                to->count++;
+                parent->keys[index] = to->keys[0];
+                parent->sizes[index - 1]--;
+                parent->sizes[index]++;
+                return;
+            }
+            Inner* from = static_cast<Inner*>(left);
+            Inner* to = static_cast<Inner*>(right);
+            int last = from->count - 1;
+            int moved_size = from->sizes[last];
+            to->keys[0] = parent->keys[index]; // The old first child is bounded by the separator
+            insertChild(to, 0, from->children[last], from->keys[last], moved_size, nullptr, nullptr);
+            parent->keys[index] = from->keys[last];
+            from->sizes[last] = 0;
+            from->count--;
+            parent->sizes[index - 1] -= moved_size;
+            parent->sizes[index] += moved_size;
+        }
+
+        // Moves one key (or child) from the right sibling of the child at index to it.
+        void borrowFromRight(Inner* parent, int index)
+        {
+            Node* left = parent->children[index];
+            Node* right = parent->children[index + 1];
+            if(left->is_leaf)
+            {
+                Leaf* to = static_cast<Leaf*>(left);
+                Leaf* from = static_cast<Leaf*>(right);
+                to->keys[to->count++] = from->keys[0];
+                std::copy(from->keys + 1, from->keys + from->count, from->keys);
+                from->count--;
+                parent->keys[index + 1] = from->keys[0];
+                parent->sizes[index]++;
+                parent->sizes[index + 1]--;
+                return;
+            }
+            Inner* to = static_cast<Inner*>(left);
+            Inner* from = static_cast<Inner*>(right);
+            int moved_size = from->sizes[0];
+            to->keys[to->count] = parent->keys[index + 1];
+            to->children[to->count] = from->children[0];
+            to->sizes[to->count] = moved_size;
+            to->count++;
+            removeChild(from, 0);
+            parent->keys[index + 1] = from->keys[0];
+            parent->sizes[index] += moved_size;
+            parent->sizes[index + 1] -= moved_size;
+        }
+
+        // Merges the child at index + 1 into the child at index, and frees it.
+        void mergeChildren(Inner* parent, int index)
+        {
+            Node* left = parent->children[index];
+            Node* right = parent->children[index + 1];
+            if(left->is_leaf)
+            {
+                Leaf* to = static_cast<Leaf*>(left);
+                Leaf* from = static_cast<Leaf*>(right);
+                std::copy(from->keys, from->keys + from->count, to->keys + to->count);
+                to->count += from->count;
+                to->next = from->next;
+                if(from->next)
+                {
+                    from->next->prev = to;
+                }
+                else
+                {
+                    last_leaf = to;
+                }
+                delete from;
+            }
+            else
+            {
+                Inner* to = static_cast<Inner*>(left);
+                Inner* from = static_cast<Inner*>(right);
+                from->keys[0] = parent->keys[index + 1];
+                std::copy(from->keys, from->keys + from->count, to->keys + to->count);
+                std::copy(from->children, from->children + from->count, to->children + to->count);
+                std::copy(from->sizes, from->sizes + from->count, to->sizes + to->count);
+                to->count += from->count;
+                delete from;
+            }
+            parent->sizes[index] += parent->sizes[index + 1];
+            removeChild(parent, index + 1);
+        }
+
+        // Fixes the child at index after it was left with too few keys (or children).
+        void fixUnderflow(Inner* parent, int index)
+        {
+            int min_count = parent->children[index]->is_leaf? MIN_LEAF : MIN_INNER;
+            if(index > 0 && parent->children[index - 1]->count > min_count)
+            {
+                borrowFromLeft(parent, index);
+            }
+            else if(index + 1 < parent->count && parent->children[index + 1]->count > min_count)
+            {
+                borrowFromRight(parent, index);
+            }
+            else if(index > 0)
+            {
+                mergeChildren(parent, index - 1);
+            }
+            else
+            {
+                mergeChildren(parent, index);
+            }
+        }
+
+        // An auxiliary erase method. Returns true if key was removed.
+        bool eraseAux(Node* node, const KEY_TYPE& key)
+        {
+            if(node->is_leaf)
+            {
+                Leaf* leaf = static_cast<Leaf*>(node);
+                int place = findKey(leaf, key);
+                if(place == leaf->count || key < leaf->keys[place])
+                {
+                    return false;
+                }
+                std::copy(leaf->keys + place + 1, leaf->keys + leaf->count, leaf->keys + place);
+                leaf->count--;
+                return true;
+            }
+            Inner* inner = static_cast<Inner*>(node);
+            int index = findChild(inner, key);
+            if(!eraseAux(inner->children[index], key))
+            {
+                return false;
+            }
+            inner->sizes[index]--;
+            Node* child = inner->children[index];
+            if(child->count < (child->is_leaf? MIN_LEAF : MIN_INNER))
+            {
+                fixUnderflow(inner, index);
+            }
+            return true;
+        }
+
+    public:
+        /**********************************/
+        /*         Public Section         */
+        /**********************************/
+        /*
+         * Class: const_iterator
+         * ---------------------------------------
+         * A bidirectional iterator over the keys of the tree in ascending order.
+         * Stepping moves inside a leaf, or to the next (or previous) leaf, so each step is O(1).
+         * Moving by a distance (+=, -=) skips whole leaves.
+         * An iterator is invalidated by any change to the tree.
+         * Decrementing end() gives the highest key.
+         */
+        class const_iterator
+        {
+        public:
+            typedef std::bidirectional_iterator_tag iterator_category;
+            typedef KEY_TYPE value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const KEY_TYPE* pointer;
+            typedef const KEY_TYPE& reference;
+
+            const_iterator() : tree(nullptr), leaf(nullptr), index(0) { }
+
+            reference operator*() const
+            {
+                return leaf->keys[index];
+            }
+
+            pointer operator->() const
+            {
+                return leaf->keys + index;
+            }
+
+            const_iterator& operator++()
+            {
+                if(++index == leaf->count)
+                {
+                    leaf = leaf->next;
+                    index = 0;
+                }
+                return *this;
+            }
+
+            const_iterator operator++(int)
+            {
+                const_iterator old = *this;
+                ++(*this);
+                return old;
+            }
+
+            const_iterator& operator--()
+            {
+                if(!leaf)
+                {
+                    leaf = tree->last_leaf;
+                    index = leaf->count - 1;
+                }
+                else if(index > 0)
+                {
+                    index--;
+                }
+                else
+                {
+                    leaf = leaf->prev;
+                    index = leaf? leaf->count - 1 : 0;
+                }
+                return *this;
+            }
+
+            const_iterator operator--(int)
+            {
+                const_iterator old = *this;
+                --(*this);
+                return old;
+            }
+
+            // Move the iterator distance keys forward or back. Whole leaves are skipped by their counts,
+            // so a move is O(distance/MIN_LEAF + 1). Moving back past the lowest key gives end().
+            const_iterator& operator+=(int distance)
+            {
+                if(distance < 0)
+                {
+                    return *this -= -distance;
+                }
+                while(leaf && index + distance >= leaf->count)
+                {
+                    distance -= leaf->count - index;
+                    leaf = leaf->next;
+                    index = 0;
+                }
+                if(leaf)
+                {
+                    index += distance;
+                }
+                return *this;
+            }
+
+            const_iterator& operator-=(int distance)
+            {
+                if(distance < 0)
+                {
+                    return *this += -distance;
+                }
+                if(distance > 0 && !leaf)
+                {
+                    --(*this);
+                    distance--;
+                }
+                while(leaf && distance > index)
+                {
+                    distance -= index + 1;
+                    leaf = leaf->prev;
+                    index = leaf? leaf->count - 1 : 0;
+                }
+                if(leaf)
+                {
+                    index -= distance;
+                }
+                return *this;
+            }
+
+            bool operator==(const const_iterator& other) const
+            {
+                return leaf == other.leaf && index == other.index;
+            }
+
+            bool operator!=(const const_iterator& other) const
+            {
+                return !(*this == other);
+            }
+
+        private:
+            friend class RankBTree;
+            const RankBTree* tree;
+            const Leaf* leaf;
+            int index;
+
+            const_iterator(const RankBTree* tree, const Leaf* leaf, int index) : tree(tree), leaf(leaf), index(index) { }
+        };
+        typedef const_iterator iterator;
+
+        /*
+         * Constructor: RankBTree
+         * Usage: RankBTree<KEY_TYPE> tree;
+         * ---------------------------------------
+         * Create an empty tree.
+         * Worst time complexity: O(1)
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        RankBTree() : root(nullptr), first_leaf(nullptr), last_leaf(nullptr), node_count(0)
+        {
+            first_leaf = last_leaf = new Leaf();
+            root = first_leaf;
+        }
+
+        RankBTree(const RankBTree& other) = delete;
+        RankBTree& operator=(const RankBTree& other) = delete;
+
+        ~RankBTree()
+        {
+            deleteTree(root);
+        }
+
+        /*
+         * Method: insert
+         * Usage: tree.insert(key);
+         * -----------------------------------
+         * Inserts key to the tree. Returns false if it was already in the tree.
+         * When n is the total number of keys in the tree, the
+         * worst time complexity for this method is O(FANOUT * log(n)/log(FANOUT)).
+         *
+         * Possible Exceptions:
+         * std::bad_alloc
+         */
+        bool insert(const KEY_TYPE& key)
+        {
+            Node* split;
+            KEY_TYPE split_key;
+            if(!insertAux(root, key, &split, &split_key))
+            {
+                return false;
+            }
+            node_count++;
+            if(split) // The root was split, so the tree grows by one level
+            {
+                Inner* new_root = new Inner();
+                new_root->children[0] = root;
+                new_root->sizes[0] = node_count - sizeOf(split);
+                new_root->keys[1] = split_key;
+                new_root->children[1] = split;
+                new_root->sizes[1] = sizeOf(split);
+                new_root->count = 2;
+                root = new_root;
+            }
+            return true;
+        }
+
+        /*
+         * Method: erase
+         * Usage: tree.erase(key);
+         * -----------------------------------
+         * Erases key from the tree. Returns false if it was not in the tree.
+         * When n is the total number of keys in the tree, the
+         * worst time complexity for this method is O(FANOUT * log(n)/log(FANOUT)).
+         */
+        bool erase(const KEY_TYPE& key)
+        {
+            if(!eraseAux(root, key))
+            {
+                return false;
+            }
+            node_count--;
+            if(!root->is_leaf && root->count == 1) // The tree shrinks by one level
+            {
+                Inner* old_root = static_cast<Inner*>(root);
+                root = old_root->children[0];
+                delete old_root;
+            }
+            return true;
+        }
+
+        /*
+         * Method: find
+         * Usage: tree.find(key);
+         * -----------------------------------
+         * Checks if the key exists in the tree.
+         * When n is the total number of keys in the tree, the
+         * worst time complexity for this method is O(log n).
+         */
+        bool find(const KEY_TYPE& key) const
+        {
+            const Node* node = root;
+            while(!node->is_leaf)
+            {
+                const Inner* inner = static_cast<const Inner*>(node);
+                node = inner->children[findChild(inner, key)];
+            }
+            const Leaf* leaf = static_cast<const Leaf*>(node);
+            int place = findKey(leaf, key);
+            return place < leaf->count && !(key < leaf->keys[place]);
+        }
+
+        /*
+         * Method: select
+         * Usage: tree.select(position);
+         * -----------------------------------
+         * Returns an iterator to the key at position in ascending order (1 for the lowest key),
+         * or end() if there is no such position.
+         * When n is the total number of keys in the tree, the
+         * worst time complexity for this method is O(FANOUT * log(n)/log(FANOUT)), done 4 children at a time.
+         */
+        const_iterator select(int position) const
+        {
+            if(position <= 0 || position > node_count)
+            {
+                return end();
+            }
+            position--;
+            const Node* node = root;
+            while(!node->is_leaf)
+            {
+                const Inner* inner = static_cast<const Inner*>(node);
+                node = inner->children[selectChild(inner, &position)];
+            }
+            return const_iterator(this, static_cast<const Leaf*>(node), position);
+        }
+
+        /*
+         * Method: countLower
+         * Usage: tree.countLower(key);
+         * -----------------------------------
+         * Returns the number of keys in the tree that are lower than key.
+         * When n is the total number of keys in the tree, the
+         * worst time complexity for this method is O(FANOUT * log(n)/log(FANOUT)).
+         */
+        int countLower(const KEY_TYPE& key) const
+        {
+            int count = 0;
+            const Node* node = root;
+            while(!node->is_leaf)
+            {
+                const Inner* inner = static_cast<const Inner*>(node);
+                int index = findChild(inner, key);
+                count += sumBefore(inner, index);
+                node = inner->children[index];
+            }
+            return count + findKey(static_cast<const Leaf*>(node), key);
+        }
+
+        /*
+         * Method: begin, end
+         * Usage: for(const KEY_TYPE& key : tree) { ... }
+         * -----------------------------------
+         * Return iterators to the lowest key, and past the highest key.
+         * The worst time and space complexity for these methods is O(1).
+         */
+        const_iterator begin() const
+        {
+            return node_count? const_iterator(this, first_leaf, 0) : end();
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(this, nullptr, 0);
+        }
+
+        /*
+         * Method: size
+         * Usage: tree.size();
+         * -----------------------------------
+         * Returns the number of keys in the tree,
+         *
+         * The worst time and space complexity for this method is O(1).
+         */
+        int size() const
+        {
+            return node_count;
+        }
+    };
+}
+#endif
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <set>
+#include <vector>
+#include "Check.h"
+#include "../RankAVL/Augmentations.h"
+
+using std::cout;
+using std::endl;
+using namespace DS;
+
+// Checks Augment over a RankAVL against a sorted std::set on random inserts and erases, with both node storages.
+// Every few operations the sums, counts and maxima of the k highest and lowest keys, the totals and the
+// n-th highest and lowest nodes are compared to the ones computed from the reference, for k in and out of range.
+// Usage: augment_test
+
+struct ViewsOf
+{
+    long long operator()(int key) const
+    {
+        return key * 7 % 13 + key;
+    }
+};
+
+struct ScoreOf
+{
+    int operator()(int key) const
+    {
+        return key * 31 % 101;
+    }
+};
+
+typedef Augment<SubtreeSum<ViewsOf>, SubtreeCount, SubtreeMax<ScoreOf>> Ranks;
+
+template<class TREE>
+void compareAugment(const TREE& tree, const std::set<int>& reference, std::mt19937& generator)
+{
+    std::vector<int> keys(reference.rbegin(), reference.rend()); // Highest first
+    int n = keys.size();
+
+    long long total = 0;
+    for(int key : keys)
+    {
+        total += ViewsOf()(key);
+    }
+    CHECK(Ranks::total<SubtreeSum<ViewsOf>>(tree) == total);
+    CHECK(Ranks::total<SubtreeCount>(tree) == n);
+
+    for(int query = 0; query < 5; query++)
+    {
+        int k = static_cast<int>(generator() % (n + 3)) - 1;
+        int taken = std::min(std::max(k, 0), n);
+        long long highest_sum = 0;
+        long long lowest_sum = 0;
+        int highest_max = std::numeric_limits<int>::lowest();
+        for(int j = 0; j < taken; j++)
+        {
+            highest_sum += ViewsOf()(keys[j]);
+            lowest_sum += ViewsOf()(keys[n - 1 - j]);
+            highest_max = std::max(highest_max, ScoreOf()(keys[j]));
+        }
+        CHECK(Ranks::highest<SubtreeSum<ViewsOf>>(tree, k) == highest_sum);
+        CHECK(Ranks::lowest<SubtreeSum<ViewsOf>>(tree, k) == lowest_sum);
+        CHECK(Ranks::highest<SubtreeMax<ScoreOf>>(tree, k) == highest_max);
+        CHECK(Ranks::highest<SubtreeCount>(tree, k) == taken);
+        CHECK(Ranks::lowest<SubtreeCount>(tree, k) == taken);
+
+        const typename TREE::NODE* highest = Ranks::nthHighest(tree, k);
+        const typename TREE::NODE* lowest = Ranks::nthLowest(tree, k);
+        if(k >= 1 && k <= n)
+        {
+            CHECK(highest && highest->key == keys[k - 1]);
+            CHECK(lowest && lowest->key == keys[n - k]);
+        }
+        else
+        {
+            CHECK(!highest && !lowest);
+        }
+    }
+}
+
+template<class STORAGE>
+void randomOperations(unsigned seed, int key_range, int operations, int compare_every)
+{
+    RankAVL<Ranks, int, Ranks::value_type, STORAGE> tree{Ranks()};
+    std::set<int> reference;
+    std::mt19937 generator(seed);
+    for(int op = 0; op < operations; op++)
+    {
+        int key = generator() % key_range;
+        if(generator() % 3)
+        {
+            tree.insert(key, Ranks::value_type());
+            reference.insert(key);
+        }
+        else
+        {
+            tree.erase(key);
+            reference.erase(key);
+        }
+        if(op % compare_every == 0)
+        {
+            compareAugment(tree, reference, generator);
+        }
+    }
+    compareAugment(tree, reference, generator);
+}
+
+int main()
+{
+    for(unsigned seed = 1; seed <= 3; seed++)
+    {
+        randomOperations<SharedNodes<int, Ranks::value_type>>(seed, 1000, 20000, 50);
+        randomOperations<NodePool<int, Ranks::value_type>>(seed, 1000, 20000, 50);
+    }
+    cout << "Augment OK" << endl;
+    return 0;
+}
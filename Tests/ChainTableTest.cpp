@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "Check.h"
+#include "../ChainTable/ChainTable.h"
+
+using std::cout;
+using std::endl;
+using namespace DS;
+
+// Checks ChainTable against std::map on random operations, with both hash policies and string values.
+// The key range grows and most keys are then erased, so the table keeps growing and shrinking, and every
+// operation may run in the middle of a migration: inserts, emplace, findOrInsert, erase, extract, lookups,
+// getBatch (compared to tryGet), reserve, and copies and assignments that are then changed on their own.
+// The hash policies are checked to give cells inside the table, and FibonacciHash to round sizes to powers of 2.
+// Then it checks that ChainTable spreads its resizes over the operations that follow them. A counting hash policy bounds
+// the keys hashed by every single insert and erase while the table grows and shrinks back, and the slowest single
+// insert into a table growing to a million keys is timed. (erases are not timed: the first large allocation after
+// many frees makes the allocator sort the freed nodes, which is outside the table)
+// Usage: chain_table_test
+
+// Fibonacci hashing that counts the keys it hashed.
+struct CountingHash
+{
+    typedef int key_type;
+    static long long calls;
+
+    static int tableSize(int requested)
+    {
+        return FibonacciHash<int>::tableSize(requested);
+    }
+
+    static int index(int key, int table_size)
+    {
+        calls++;
+        return FibonacciHash<int>::index(key, table_size);
+    }
+};
+
+long long CountingHash::calls = 0;
+
+// Checks that every key of the reference, and a few keys around them, are found in the table as they are in it.
+template<class HASH>
+void compareTable(ChainTable<std::string, HASH>& table, const std::map<int, std::string>& reference, int key_range)
+{
+    CHECK(table.size() == static_cast<int>(reference.size()));
+    const ChainTable<std::string, HASH>& const_table = table;
+    for(int key = 0; key < key_range; key++)
+    {
+        auto found = reference.find(key);
+        const std::string* value = const_table.tryGet(key);
+        CHECK(table.find(key) == (found != reference.end()));
+        CHECK(found == reference.end()? !value : value && *value == found->second);
+    }
+}
+
+template<class HASH>
+void randomOperations(unsigned seed, int operations)
+{
+    typedef ChainTable<std::string, HASH> Table;
+    Table table;
+    std::map<int, std::string> reference;
+    std::mt19937 generator(seed);
+    const int key_range = 6000;
+    for(int op = 0; op < operations; op++)
+    {
+        // Phases of mostly inserts over a growing range, mixed operations, and mostly erases:
+        int phase = (op / 3000) % 3;
+        int range = phase == 0? 1 + key_range * (op % 3000) / 3000 : key_range;
+        int key = generator() % range;
+        std::string value = std::to_string(generator());
+        int dice = generator() % 100;
+        if(phase == 2 && dice < 60)
+        {
+            dice = 60; // erase
+        }
+        if(phase == 0 && dice >= 40 && dice < 80)
+        {
+            dice = 0; // insert
+        }
+
+        if(dice < 15)
+        {
+            table.insert(key, value);
+            reference[key] = value;
+        }
+        else if(dice < 22)
+        {
+            std::string moved = value;
+            table.insert(key, std::move(moved));
+            reference[key] = value;
+        }
+        else if(dice < 30)
+        {
+            CHECK(table.emplace(key, value) == (reference.count(key) == 0));
+            reference.insert(std::make_pair(key, value));
+        }
+        else if(dice < 38)
+        {
+            std::string& found = table.findOrInsert(key, [&value]() { return value; });
+            reference.insert(std::make_pair(key, value));
+            CHECK(found == reference[key]);
+            found += "!"; // The reference is to the value in the table
+            reference[key] += "!";
+        }
+        else if(dice < 40)
+        {
+            int count = generator() % (2 * table.size() + 100);
+            table.reserve(count);
+            CHECK(table.tableSize() >= HASH::tableSize(count > 1? count : 1));
+        }
+        else if(dice < 70)
+        {
+            table.erase(key);
+            reference.erase(key);
+        }
+        else if(dice < 80)
+        {
+            std::string extracted;
+            bool found = table.extract(key, [&extracted](std::string& in_table) { extracted = in_table; });
+            CHECK(found == (reference.count(key) > 0));
+            CHECK(!found || extracted == reference[key]);
+            reference.erase(key);
+        }
+        else if(dice < 90)
+        {
+            bool in_reference = reference.count(key) > 0;
+            const std::string* found = table.tryGet(key);
+            CHECK((found != nullptr) == in_reference);
+            bool thrown = false;
+            try
+            {
+                const std::string& in_table = table.get(key);
+                CHECK(in_reference && in_table == reference[key]);
+            }
+            catch(const KeyNotFound& e)
+            {
+                thrown = true;
+            }
+            CHECK(thrown == !in_reference);
+        }
+        else if(dice < 99)
+        {
+            // A batch that crosses a few groups, with keys that are and are not in the table, and repeated keys:
+            int count = 1 + generator() % 60;
+            std::vector<int> keys(count);
+            for(int& batch_key : keys)
+            {
+                batch_key = generator() % 8 == 0? keys[0] : static_cast<int>(generator() % range);
+            }
+            std::vector<const std::string*> out(count);
+            const Table& const_table = table;
+            const_table.getBatch(keys.data(), count, out.data());
+            for(int i = 0; i < count; i++)
+            {
+                CHECK(out[i] == const_table.tryGet(keys[i]));
+            }
+            std::vector<std::string*> mutable_out(count);
+            table.getBatch(keys.data(), count, mutable_out.data());
+            CHECK(std::equal(mutable_out.begin(), mutable_out.end(), out.begin()));
+        }
+        else
+        {
+            // A copy, and an assignment over a table with other keys, are changed without changing the table:
+            Table copy(table);
+            Table assigned(1);
+            assigned.insert(key_range + 1, "other");
+            assigned = table;
+            std::map<int, std::string> changed = reference;
+            for(int i = 0; i < 50; i++)
+            {
+                int changed_key = generator() % key_range;
+                copy.erase(changed_key);
+                assigned.erase(changed_key);
+                changed.erase(changed_key);
+                copy.insert(key_range + i, "copy");
+                assigned.insert(key_range + i, "copy");
+                changed[key_range + i] = "copy";
+            }
+            compareTable(copy, changed, key_range + 50);
+            compareTable(assigned, changed, key_range + 50);
+        }
+        CHECK(table.size() == static_cast<int>(reference.size()));
+        if(op % 1499 == 0)
+        {
+            compareTable(table, reference, key_range + 50);
+        }
+    }
+    compareTable(table, reference, key_range + 50);
+}
+
+// Checks that the hash policies give cells inside the table, and that FibonacciHash rounds sizes to powers of 2.
+void hashPolicies()
+{
+    std::mt19937 generator(1);
+    for(int bits = 0; bits <= 30; bits++)
+    {
+        int size = 1 << bits;
+        for(int i = 0; i < 1000; i++)
+        {
+            int key = static_cast<int>(generator());
+            int cell = FibonacciHash<int>::index(key, size);
+            CHECK(cell >= 0 && cell < size);
+            cell = FibonacciHash<long long>::index(key * (1LL << 20), size);
+            CHECK(cell >= 0 && cell < size);
+        }
+    }
+    for(int requested = 1; requested < (1 << 24); requested += 1 + requested / 7)
+    {
+        int size = FibonacciHash<int>::tableSize(requested);
+        CHECK(size > 0 && (size & (size - 1)) == 0);
+        CHECK(size <= requested * 1.4142 + 1 && size * 1.4142 >= requested);
+    }
+    CHECK(FibonacciHash<int>::tableSize(1 << 30) == 1 << 30);
+    bool thrown = false;
+    try
+    {
+        FibonacciHash<int>::tableSize(INT_MAX);
+    }
+    catch(const std::bad_alloc& e)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    for(int size = 1; size < 5000; size += 1 + size / 3)
+    {
+        CHECK(GoldenRatioHash<int>::tableSize(size) == size);
+        for(int i = 0; i < 1000; i++)
+        {
+            int cell = GoldenRatioHash<int>::index(generator() % INT_MAX, size);
+            CHECK(cell >= 0 && cell < size);
+        }
+    }
+}
+
+// The key of the operation, the old and new cells of it during a resize, and the keys of the few buckets migrated.
+const int MAX_HASHES_PER_OPERATION = 32;
+
+// Grows a table to count keys and shrinks it back to none, checking how many keys every operation hashed.
+void resizeWork(int count)
+{
+    ChainTable<int, CountingHash> table;
+    int resizes = 0;
+    for(int key = 0; key < count; key++)
+    {
+        int table_size = table.tableSize();
+        long long before = CountingHash::calls;
+        table.insert(key, key);
+        CHECK(CountingHash::calls - before <= MAX_HASHES_PER_OPERATION);
+        resizes += table.tableSize() != table_size;
+    }
+    CHECK(table.size() == count && table.tableSize() >= count / 2);
+    for(int key = 0; key < count; key++)
+    {
+        int table_size = table.tableSize();
+        long long before = CountingHash::calls;
+        table.erase(key);
+        CHECK(CountingHash::calls - before <= MAX_HASHES_PER_OPERATION);
+        resizes += table.tableSize() != table_size;
+    }
+    CHECK(table.size() == 0);
+    CHECK(resizes >= 20);
+}
+
+// Returns the longest time a single insert took, in milliseconds, while count keys were inserted into an empty table.
+double worstInsert(int count)
+{
+    ChainTable<int> table;
+    double worst = 0;
+    for(int key = 0; key < count; key++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        table.insert(key, key);
+        std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - start;
+        worst = std::max(worst, took.count());
+    }
+    return worst;
+}
+
+int main()
+{
+    hashPolicies();
+    randomOperations<FibonacciHash<int>>(1, 24000);
+    randomOperations<GoldenRatioHash<int>>(2, 24000);
+    resizeWork(1 << 17);
+
+    // A resize that constructs or destroys every bucket at once takes about 50 ms at this size (without optimizations),
+    // while a spread one stays a few ms. Up to three runs are timed, to skip a thread that was descheduled.
+    double worst = worstInsert(1 << 20);
+    for(int run = 1; run < 3 && worst >= 20; run++)
+    {
+        worst = std::min(worst, worstInsert(1 << 20));
+    }
+    cout << "Slowest insert: " << worst << " ms" << endl;
+    CHECK(worst < 20);
+
+    cout << "ChainTable OK" << endl;
+    return 0;
+}
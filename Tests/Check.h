@@ -0,0 +1,17 @@
+#ifndef _TEST_CHECK_H
+#define _TEST_CHECK_H
+#include <cstdlib>
+#include <iostream>
+
+// Stops the test, naming the condition that failed and where.
+#define CHECK(condition) \
+do \
+{ \
+    if(!(condition)) \
+    { \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+        exit(1); \
+    } \
+} while(0)
+
+#endif
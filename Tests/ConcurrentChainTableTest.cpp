@@ -0,0 +1,218 @@
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Check.h"
+#include "../ChainTable/ConcurrentChainTable.h"
+
+using std::cout;
+using std::endl;
+using namespace DS;
+
+// Checks ConcurrentChainTable with writer threads and lock-free reader threads running at once.
+// Every writer owns the keys that leave it as the remainder, and checks its keys against its own std::map while
+// it inserts, emplaces, updates and erases them. Its keys grow and are then mostly erased, again and again, so the
+// few shards of the table keep resizing under the readers. A block of stable keys is only ever updated.
+// The readers read, get and find random keys: every value they see must be whole and belong to its key,
+// the stable keys must always be found, and a reader must never see a stable key go back to an older version.
+// At the end the table must hold exactly the keys of the writers and the stable keys.
+// Usage: concurrent_chain_table_test
+
+// A value that names its key and its version twice, so a torn or freed value does not pass as whole.
+struct Record
+{
+    int key;
+    int version;
+    std::string text;
+
+    Record(int key, int version) : key(key), version(version), text(describe(key, version)) { }
+
+    static std::string describe(int key, int version)
+    {
+        return std::to_string(key) + ":" + std::to_string(version);
+    }
+
+    bool whole(int expected_key) const
+    {
+        return key == expected_key && text == describe(key, version);
+    }
+};
+
+typedef ConcurrentChainTable<Record, FibonacciHash<int>, 4> Table;
+
+const int STABLE_KEYS = 64; // The keys -1 to -STABLE_KEYS are never erased
+
+// Writes the keys that leave writer as the remainder mod writers, and checks them against reference.
+void write(Table& table, int writer, int writers, int key_range, int operations, std::map<int, int>& reference, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    int version = 0;
+    for(int op = 0; op < operations; op++)
+    {
+        // Phases of mostly inserts over a growing range, and of mostly erases:
+        bool growing = (op / 4000) % 2 == 0;
+        int range = growing? 1 + key_range * (op % 4000) / 4000 : key_range;
+        int key = static_cast<int>(generator() % range) / writers * writers + writer;
+        int dice = generator() % 100;
+        if(!growing && dice < 50)
+        {
+            dice = 40; // erase
+        }
+        version++;
+
+        if(dice < 15)
+        {
+            table.insert(key, Record(key, version));
+            reference[key] = version;
+        }
+        else if(dice < 25)
+        {
+            const Record record(key, version);
+            table.insert(key, record);
+            reference[key] = version;
+        }
+        else if(dice < 35)
+        {
+            CHECK(table.emplace(key, key, version) == (reference.count(key) == 0));
+            reference.insert(std::make_pair(key, version));
+        }
+        else if(dice < 55)
+        {
+            table.erase(key);
+            reference.erase(key);
+        }
+        else if(dice < 70)
+        {
+            bool updated = table.update(key, [version](Record& record)
+            {
+                record = Record(record.key, version);
+            });
+            CHECK(updated == (reference.count(key) > 0));
+            if(updated)
+            {
+                reference[key] = version;
+            }
+        }
+        else if(dice < 80)
+        {
+            // The stable keys of the writer move to newer versions:
+            int stable = -1 - static_cast<int>(generator() % (STABLE_KEYS / writers)) * writers - writer;
+            CHECK(table.update(stable, [version](Record& record)
+            {
+                CHECK(record.version < version);
+                record = Record(record.key, version);
+            }));
+        }
+        else
+        {
+            // No other thread writes the keys of the writer, so it sees exactly what it wrote:
+            auto found = reference.find(key);
+            bool in_table = table.read(key, [&](const Record& record)
+            {
+                CHECK(record.whole(key) && found != reference.end() && record.version == found->second);
+            });
+            CHECK(in_table == (found != reference.end()));
+            CHECK(table.find(key) == in_table);
+        }
+    }
+}
+
+// Reads random keys until done is set, checking every value it sees.
+void read(const Table& table, int key_range, const std::atomic<bool>& done, unsigned seed)
+{
+    std::mt19937 generator(seed);
+    std::vector<int> stable_seen(STABLE_KEYS + 1, 0); // The newest version of each stable key this reader saw
+    while(!done.load())
+    {
+        int stable = -1 - static_cast<int>(generator() % STABLE_KEYS);
+        CHECK(table.find(stable));
+        CHECK(table.read(stable, [&](const Record& record)
+        {
+            CHECK(record.whole(stable) && record.version >= stable_seen[-stable]);
+            stable_seen[-stable] = record.version;
+        }));
+        Record copy = table.get(stable);
+        CHECK(copy.whole(stable) && copy.version >= stable_seen[-stable]);
+        stable_seen[-stable] = copy.version;
+
+        int key = generator() % key_range;
+        table.read(key, [key](const Record& record) { CHECK(record.whole(key)); });
+        try
+        {
+            CHECK(table.get(key).whole(key));
+        }
+        catch(const KeyNotFound& e)
+        {
+        }
+        table.find(key);
+    }
+}
+
+void stress(unsigned seed, int writers, int readers, int key_range, int operations)
+{
+    Table* table = new Table();
+    for(int stable = -1; stable >= -STABLE_KEYS; stable--)
+    {
+        table->insert(stable, Record(stable, 0));
+    }
+
+    std::atomic<bool> done(false);
+    std::vector<std::thread> reader_threads;
+    for(int i = 0; i < readers; i++)
+    {
+        reader_threads.emplace_back(read, std::cref(*table), key_range, std::cref(done), seed * 100 + i);
+    }
+    std::vector<std::map<int, int>> references(writers);
+    std::vector<std::thread> writer_threads;
+    for(int i = 0; i < writers; i++)
+    {
+        writer_threads.emplace_back(write, std::ref(*table), i, writers, key_range, operations,
+                                    std::ref(references[i]), seed * 100 + readers + i);
+    }
+    for(std::thread& thread : writer_threads)
+    {
+        thread.join();
+    }
+    done.store(true);
+    for(std::thread& thread : reader_threads)
+    {
+        thread.join();
+    }
+
+    int count = STABLE_KEYS;
+    for(const std::map<int, int>& reference : references)
+    {
+        count += reference.size();
+    }
+    CHECK(table->size() == count);
+    for(int key = 0; key < key_range; key++)
+    {
+        const std::map<int, int>& reference = references[key % writers];
+        auto found = reference.find(key);
+        CHECK(table->find(key) == (found != reference.end()));
+        if(found != reference.end())
+        {
+            Record record = table->get(key);
+            CHECK(record.whole(key) && record.version == found->second);
+        }
+    }
+    for(int stable = -1; stable >= -STABLE_KEYS; stable--)
+    {
+        CHECK(table->get(stable).whole(stable));
+    }
+    delete table;
+}
+
+int main()
+{
+    for(unsigned seed = 1; seed <= 2; seed++)
+    {
+        stress(seed, 2, 3, 6000, 40000);
+        stress(seed, 4, 1, 600, 20000);
+    }
+    cout << "ConcurrentChainTable OK" << endl;
+    return 0;
+}
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include "Check.h"
+#include "../DynamicArray/DynamicArray.h"
+
+using std::cout;
+using std::endl;
+using namespace DS;
+
+// Checks DynamicArray, with and without incremental growth, against std::map on random stores, reserves,
+// truncates, copies and moves, for realloc factors 1 to 3. After every operation a sample of the cells is compared
+// with the reference (the reads also move cells of a growing array), and a store out of bounds must throw.
+// The values count how many of them are alive, so a cell that is constructed before it is stored into,
+// or destroyed twice or never, is caught. A large array must be created without constructing its cells.
+// Usage: dynamic_array_test
+
+// A string that counts the live instances of its type.
+class Value
+{
+    std::string text;
+public:
+    static int live;
+
+    Value(const std::string& text = "default") : text(text)
+    {
+        live++;
+    }
+
+    Value(const Value& other) : text(other.text)
+    {
+        live++;
+    }
+
+    Value(Value&& other) : text(std::move(other.text))
+    {
+        live++;
+    }
+
+    ~Value()
+    {
+        live--;
+    }
+
+    Value& operator=(const Value& other) = default;
+    Value& operator=(Value&& other) = default;
+
+    bool operator==(const std::string& other) const
+    {
+        return text == other;
+    }
+};
+
+int Value::live = 0;
+
+template<bool INCREMENTAL_GROWTH>
+void compareArray(DynamicArray<Value, INCREMENTAL_GROWTH>& array, const std::map<int, std::string>& reference)
+{
+    CHECK(array.initialized() == static_cast<int>(reference.size()));
+    for(int i = 0; i < array.size(); i += 1 + array.size() / 50)
+    {
+        auto found = reference.find(i);
+        bool stored = found != reference.end();
+        CHECK(array.isInitialized(i) == stored);
+        CHECK(array.get(i) == (stored? found->second : std::string("default")));
+    }
+}
+
+template<bool INCREMENTAL_GROWTH>
+void randomOperations(unsigned seed, int realloc_factor, int operations)
+{
+    typedef DynamicArray<Value, INCREMENTAL_GROWTH> Array;
+    std::mt19937 generator(seed);
+    Array array(1 + generator() % 20, Value("default"), realloc_factor);
+    std::map<int, std::string> reference;
+    for(int op = 0; op < operations; op++)
+    {
+        int size = array.size();
+        int i = generator() % size;
+        int dice = generator() % 100;
+        if(dice < 60)
+        {
+            std::string val = std::to_string(generator());
+            array.store(i, Value(val));
+            reference[i] = val;
+        }
+        else if(dice < 63)
+        {
+            int count = size + generator() % 30;
+            array.reserve(count);
+            CHECK(array.size() >= count);
+        }
+        else if(dice < 64)
+        {
+            Array copy(array);
+            Array moved(1);
+            moved = std::move(copy);
+            compareArray(moved, reference);
+            array = moved;
+        }
+        else if(dice < 65)
+        {
+            bool thrown = false;
+            try
+            {
+                array.store(array.size(), Value("out"));
+            }
+            catch(const OutOfBounds&)
+            {
+                thrown = true;
+            }
+            CHECK(thrown);
+        }
+        else if(dice < 67)
+        {
+            int new_size = 1 + generator() % size;
+            array.truncate(new_size);
+            CHECK(array.size() == new_size);
+            reference.erase(reference.lower_bound(new_size), reference.end());
+        }
+        compareArray(array, reference);
+        CHECK(Value::live == array.initialized() + 1); // And the default value
+    }
+}
+
+// Creating an array constructs no cell, and taking it apart from the end destroys only the initialized cells.
+void lazyCells()
+{
+    const int size = 1 << 20;
+    {
+        DynamicArray<Value> array(size);
+        CHECK(Value::live == 1);
+        for(int i = 0; i < size; i += 1000)
+        {
+            array.store(i, Value("stored"));
+        }
+        CHECK(Value::live == array.initialized() + 1);
+        for(int new_size = size - 1; new_size >= size / 2; new_size--)
+        {
+            array.truncate(new_size);
+        }
+        CHECK(array.initialized() == (size / 2 + 999) / 1000);
+        CHECK(Value::live == array.initialized() + 1);
+        array.truncate(0);
+        CHECK(Value::live == 1);
+    }
+    CHECK(Value::live == 0);
+}
+
+int main()
+{
+    for(int realloc_factor = 1; realloc_factor <= 3; realloc_factor++)
+    {
+        for(unsigned seed = 1; seed <= 20; seed++)
+        {
+            randomOperations<false>(seed, realloc_factor, 3000);
+            randomOperations<true>(seed, realloc_factor, 3000);
+            CHECK(Value::live == 0);
+        }
+    }
+    lazyCells();
+    cout << "DynamicArray OK" << endl;
+    return 0;
+}
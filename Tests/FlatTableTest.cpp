@@ -0,0 +1,131 @@
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include "Check.h"
+#include "../FlatTable/FlatTable.h"
+
+using std::cout;
+using std::endl;
+using namespace DS;
+
+// Checks FlatTable against std::map on random inserts, erases, extracts and lookups, with string values
+// (so moves and destructors run) and negative keys. The key range changes every few thousand operations,
+// so the table grows, fills with DELETED slots and is rehashed. Copies and reserve are checked as well.
+// Usage: flat_table_test
+
+void randomOperations(unsigned seed, int operations)
+{
+    FlatTable<std::string> table;
+    std::map<int, std::string> reference;
+    std::mt19937 generator(seed);
+    for(int op = 0; op < operations; op++)
+    {
+        int key_range = (op / 20000) % 2? 300 : 5000;
+        int key = static_cast<int>(generator() % key_range) - 50;
+        std::string value = std::to_string(generator());
+        int dice = generator() % 9;
+        if(dice < 2)
+        {
+            table.insert(key, value);
+            reference[key] = value;
+        }
+        else if(dice == 2)
+        {
+            std::string moved = value;
+            table.insert(key, std::move(moved));
+            reference[key] = value;
+        }
+        else if(dice == 3)
+        {
+            CHECK(table.emplace(key, value) == (reference.count(key) == 0));
+            reference.insert(std::make_pair(key, value));
+        }
+        else if(dice == 4)
+        {
+            std::string& found = table.findOrInsert(key, [&value]() { return value; });
+            reference.insert(std::make_pair(key, value));
+            CHECK(found == reference[key]);
+        }
+        else if(dice == 5)
+        {
+            table.erase(key);
+            reference.erase(key);
+        }
+        else if(dice == 6)
+        {
+            std::string extracted;
+            bool found = table.extract(key, [&extracted](std::string& value) { extracted = std::move(value); });
+            CHECK(found == (reference.count(key) > 0));
+            CHECK(!found || extracted == reference[key]);
+            CHECK(!table.find(key));
+            reference.erase(key);
+        }
+        else
+        {
+            bool in_reference = reference.count(key) > 0;
+            CHECK(table.find(key) == in_reference);
+            const std::string* found = table.tryGet(key);
+            CHECK((found != nullptr) == in_reference);
+            if(in_reference)
+            {
+                CHECK(*found == reference[key]);
+                CHECK(table.get(key) == reference[key]);
+            }
+            else
+            {
+                bool thrown = false;
+                try
+                {
+                    table.get(key);
+                }
+                catch(const KeyNotFound& e)
+                {
+                    thrown = true;
+                }
+                CHECK(thrown);
+            }
+        }
+        if(op % 5000 == 4999)
+        {
+            FlatTable<std::string> copy(table);
+            FlatTable<std::string> assigned;
+            assigned = copy;
+            table = assigned;
+        }
+        CHECK(table.size() == static_cast<int>(reference.size()));
+    }
+    for(const std::pair<const int, std::string>& pair : reference)
+    {
+        CHECK(table.get(pair.first) == pair.second);
+    }
+}
+
+// After reserve, inserting that many keys must not grow the table.
+void reserved(int count)
+{
+    FlatTable<int> table;
+    table.reserve(count);
+    int table_size = table.tableSize();
+    for(int key = 0; key < count; key++)
+    {
+        table.insert(key, key);
+    }
+    CHECK(table.tableSize() == table_size);
+    for(int key = 0; key < count; key++)
+    {
+        CHECK(table.get(key) == key);
+    }
+}
+
+int main()
+{
+    for(unsigned seed = 1; seed <= 3; seed++)
+    {
+        randomOperations(seed, 100000);
+    }
+    reserved(1000);
+    reserved(100000);
+    cout << "FlatTable OK" << endl;
+    return 0;
+}
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Check.h"
+#include "../RankAVL/PersistentRankAVL.h"
+
+using std::cout;
+using std::endl;
+using namespace DS;
+
+// Checks PersistentRankAVL and its snapshots against std::set on random inserts and erases. Snapshots are taken
+// and dropped along the way, and each one must keep the keys it was taken with while the tree keeps changing.
+// Every few operations the tree and all the live snapshots are checked: the AVL invariants, the size kept in
+// the values, both traversals, the lowest and highest keys and a select through rank.
+// Then one thread keeps writing to a tree and handing snapshots of it to reader threads, which check them
+// while the writer goes on, and drop them so that the writer changes their nodes in place afterwards.
+// Usage: persistent_rank_avl_test
+
+typedef RankSnapshot<int, int> Snapshot;
+typedef Snapshot::NODE Node;
+
+// Keeps the size of each subtree in the node's value.
+struct SubtreeSize
+{
+    void operator()(Node& node, const Node* left, const Node* right) const
+    {
+        node.val = (left? left->val : 0) + (right? right->val : 0) + 1;
+    }
+};
+
+// Ends the search at the root.
+struct AtRoot
+{
+    SearchPath operator()(const Node&, const Node*, const Node*) const
+    {
+        return SearchPath::end;
+    }
+};
+
+// Ends the search at the i-th lowest key, reading the subtree sizes.
+class Select
+{
+    int i;
+public:
+    explicit Select(int i) : i(i) { }
+    SearchPath operator()(const Node&, const Node* left, const Node*)
+    {
+        int left_size = left? left->val : 0;
+        if(i == left_size + 1)
+        {
+            return SearchPath::end;
+        }
+        if(i <= left_size)
+        {
+            return SearchPath::left;
+        }
+        i -= left_size + 1;
+        return SearchPath::right;
+    }
+};
+
+struct CollectInOrder
+{
+    std::vector<int> keys;
+    void operator()(const Node& node, int* k)
+    {
+        keys.push_back(node.key);
+        (*k)--;
+    }
+};
+
+struct CollectReverse
+{
+    std::vector<int> keys;
+    void operator()(const Node& node)
+    {
+        keys.push_back(node.key);
+    }
+};
+
+// Checks the subtree of node, whose keys must lie between low and high (a null bound is open), and returns its height.
+int checkSubtree(const Node* node, const int* low, const int* high, int* count)
+{
+    if(!node)
+    {
+        return -1;
+    }
+    CHECK(!low || *low < node->key);
+    CHECK(!high || node->key < *high);
+    int left_height = checkSubtree(node->left.get(), low, &node->key, count);
+    int right_height = checkSubtree(node->right.get(), &node->key, high, count);
+    CHECK(node->height == std::max(left_height, right_height) + 1);
+    CHECK(std::abs(left_height - right_height) <= 1);
+    CHECK(node->val == (node->left? node->left->val : 0) + (node->right? node->right->val : 0) + 1);
+    (*count)++;
+    return node->height;
+}
+
+void compareSnapshot(const Snapshot& snapshot, const std::set<int>& reference)
+{
+    std::vector<int> keys(reference.begin(), reference.end());
+    int n = keys.size();
+    CHECK(snapshot.size() == n);
+
+    int count = 0;
+    checkSubtree(snapshot.rank(AtRoot()), nullptr, nullptr, &count);
+    CHECK(count == n);
+
+    CollectInOrder in_order;
+    snapshot.inOrder(in_order);
+    CHECK(in_order.keys == keys);
+    CollectInOrder first;
+    snapshot.inOrder(first, 3);
+    CHECK(first.keys == std::vector<int>(keys.begin(), keys.begin() + std::min(n, 3)));
+    CollectReverse last;
+    snapshot.reverseInOrder(last, 5);
+    CHECK(last.keys == std::vector<int>(keys.rbegin(), keys.rbegin() + std::min(n, 5)));
+
+    if(n == 0)
+    {
+        CHECK(!snapshot.getLowest() && !snapshot.getHighest());
+        CHECK(!snapshot.rank(Select(1)));
+        return;
+    }
+    CHECK(snapshot.getLowest()->key == keys.front());
+    CHECK(snapshot.getHighest()->key == keys.back());
+    for(int i : {1, n / 2 + 1, n})
+    {
+        CHECK(snapshot.rank(Select(i))->key == keys[i - 1]);
+    }
+    CHECK(!snapshot.rank(Select(n + 1)));
+}
+
+void randomOperations(unsigned seed, int key_range, int operations, int compare_every)
+{
+    PersistentRankAVL<SubtreeSize, int, int> tree{SubtreeSize()};
+    std::set<int> reference;
+    std::vector<std::pair<Snapshot, std::set<int>>> snapshots;
+    std::mt19937 generator(seed);
+    for(int op = 0; op < operations; op++)
+    {
+        int key = generator() % key_range;
+        if(generator() % 2)
+        {
+            tree.insert(key, 0);
+            reference.insert(key);
+        }
+        else
+        {
+            tree.erase(key);
+            reference.erase(key);
+        }
+        CHECK(tree.find(key) == (reference.count(key) > 0));
+        CHECK(tree.size() == static_cast<int>(reference.size()));
+
+        if(op % 500 == 0)
+        {
+            snapshots.push_back(std::make_pair(tree.snapshot(), reference));
+        }
+        if(op % 1700 == 0)
+        {
+            snapshots.erase(snapshots.begin() + generator() % snapshots.size());
+        }
+        if(op % compare_every == 0)
+        {
+            compareSnapshot(tree, reference);
+            for(const auto& snapshot : snapshots)
+            {
+                compareSnapshot(snapshot.first, snapshot.second);
+            }
+        }
+    }
+    compareSnapshot(tree, reference);
+    for(const auto& snapshot : snapshots)
+    {
+        compareSnapshot(snapshot.first, snapshot.second);
+    }
+
+    // A copy of the tree shares its nodes, but changing it must not change the original.
+    PersistentRankAVL<SubtreeSize, int, int> copy(tree);
+    copy.insert(key_range, 0);
+    CHECK(copy.find(key_range) && !tree.find(key_range));
+    reference.insert(key_range);
+    compareSnapshot(copy, reference);
+    reference.erase(key_range);
+    compareSnapshot(tree, reference);
+}
+
+// A snapshot handed from the writer to the readers, with the keys it was taken with.
+struct Published
+{
+    Snapshot snapshot;
+    std::set<int> keys;
+};
+
+void concurrentReaders(unsigned seed, int readers, int key_range, int operations)
+{
+    std::mutex lock;
+    Published published;
+    bool done = false;
+
+    auto read = [&]()
+    {
+        for(bool last = false; !last;)
+        {
+            Published copy;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                last = done;
+                copy = published;
+            }
+            compareSnapshot(copy.snapshot, copy.keys);
+        } // The copy is dropped here, while the writer may be changing the nodes it no longer shares
+    };
+    std::vector<std::thread> threads;
+    for(int i = 0; i < readers; i++)
+    {
+        threads.emplace_back(read);
+    }
+
+    PersistentRankAVL<SubtreeSize, int, int> tree{SubtreeSize()};
+    std::set<int> reference;
+    std::mt19937 generator(seed);
+    for(int op = 0; op < operations; op++)
+    {
+        int key = generator() % key_range;
+        if(generator() % 2)
+        {
+            tree.insert(key, 0);
+            reference.insert(key);
+        }
+        else
+        {
+            tree.erase(key);
+            reference.erase(key);
+        }
+        if(op % 64 == 0)
+        {
+            Published next = {tree.snapshot(), reference};
+            std::lock_guard<std::mutex> guard(lock);
+            published = next;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        done = true;
+    }
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    compareSnapshot(tree, reference);
+}
+
+int main()
+{
+    for(unsigned seed = 1; seed <= 3; seed++)
+    {
+        randomOperations(seed, 600, 30000, 211);
+        randomOperations(seed, 20000, 30000, 4999);
+        concurrentReaders(seed, 3, 500, 20000);
+    }
+    cout << "PersistentRankAVL OK" << endl;
+    return 0;
+}
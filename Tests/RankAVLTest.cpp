@@ -0,0 +1,800 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <type_traits>
+#include <vector>
+#include "Check.h"
+#include "../RankAVL/RankAVL.h"
+
+using std::cout;
+using std::endl;
+using namespace DS;
+
+// Checks RankAVL against std::set on random operations, with both node storages and two kinds of ranks:
+// the size of every subtree, and the heaviest key in it, which often stays the same when the subtree changes,
+// so the retrace stops early. After every operation the whole tree is checked: the order of the keys,
+// the heights and balance factors, the father links, every rank recalculated from its children,
+// and the lowest and highest nodes, which erases of the lowest and highest keys (by key and by handle) move.
+// Every few operations the iterators walk the tree forward and backward, lower_bound and upper_bound are
+// compared to the ones of std::set at, between and past both ends, and rankIterator walks on from the node
+// it selects (by the subtree sizes) or from the root.
+// Long runs of sorted inserts and erases check that the height stays within the AVL bound.
+// Trees are split at random keys (with and without counting the halves by their subtree sizes)
+// into trees that held other keys, and the halves are checked and joined back around a middle key.
+// With a NodePool the nodes of the smaller half or tree are adopted into the pool of the larger one,
+// so the pools of the trees are swapped whenever the higher half or tree is the larger.
+// The nodes of random handles are erased, and given new keys that keep their place, move them elsewhere,
+// or are already taken (which must throw and leave the tree as it was), while all the other handles stay valid.
+// Trees of 0, 1, 2^k - 1, 2^k and random numbers of keys are built with assignSorted, assignUnsorted (from
+// shuffled keys with duplicates) and the range constructor, over trees that held other keys, for RankAVL and
+// for the AVL without ranks. They must be perfectly balanced, with every rank in place, and take later changes.
+// NodePool is checked on its own: the cell 0 is the null link, released cells are reused (last first) and reset,
+// reserve keeps the slab in place, and swap, adopt, clear and copies move or copy the right nodes.
+// A pooled tree reuses the cells of the keys it erased, and keeps its nodes in place after a reserve.
+// Usage: rank_avl_test
+
+// Keeps the size of each subtree in the node's value.
+struct SubtreeSize
+{
+    template<class NODE>
+    void operator()(NODE& node, const NODE* left, const NODE* right) const
+    {
+        node.val = (left? left->val : 0) + (right? right->val : 0) + 1;
+    }
+};
+
+// Keeps the heaviest weight of a key in each subtree in the node's value.
+struct HeaviestKey
+{
+    static int weight(int key)
+    {
+        return key * 7 % 11;
+    }
+
+    template<class NODE>
+    void operator()(NODE& node, const NODE* left, const NODE* right) const
+    {
+        node.val = std::max(weight(node.key), std::max(left? left->val : 0, right? right->val : 0));
+    }
+};
+
+// Returns the size of the subtree of a node, for a tree ranked by SubtreeSize.
+struct SizeOf
+{
+    template<class NODE>
+    int operator()(const NODE& node) const
+    {
+        return node.val;
+    }
+};
+
+// Ends the search at the i-th lowest key, reading the subtree sizes.
+class Select
+{
+    int i;
+public:
+    explicit Select(int i) : i(i) { }
+
+    template<class NODE>
+    SearchPath operator()(const NODE&, const NODE* left, const NODE*)
+    {
+        int left_size = left? left->val : 0;
+        if(i == left_size + 1)
+        {
+            return SearchPath::end;
+        }
+        if(i <= left_size)
+        {
+            return SearchPath::left;
+        }
+        i -= left_size + 1;
+        return SearchPath::right;
+    }
+};
+
+// Ends the search at the root.
+struct AtRoot
+{
+    template<class NODE>
+    SearchPath operator()(const NODE&, const NODE*, const NODE*) const
+    {
+        return SearchPath::end;
+    }
+};
+
+// Keeps nothing, for trees without ranks.
+struct NoRank
+{
+    template<class NODE>
+    void operator()(NODE&, const NODE*, const NODE*) const { }
+};
+
+// Checks the subtree of node in nodes, whose keys must lie between low and high (a null bound is open),
+// and appends its keys in order. Every rank is recalculated from the children with RANK. Returns the height.
+template<class RANK, class STORAGE>
+int checkSubtree(const STORAGE& nodes, const typename STORAGE::link& node, const typename STORAGE::link& father,
+                 const int* low, const int* high, std::vector<int>& keys)
+{
+    if(!node)
+    {
+        return -1;
+    }
+    const typename STORAGE::node_type& current = nodes[node];
+    CHECK(current.father == father);
+    CHECK(!low || *low < current.key);
+    CHECK(!high || current.key < *high);
+    int left_height = checkSubtree<RANK>(nodes, current.left, node, low, &current.key, keys);
+    keys.push_back(current.key);
+    int right_height = checkSubtree<RANK>(nodes, current.right, node, &current.key, high, keys);
+    CHECK(current.height == std::max(left_height, right_height) + 1);
+    CHECK(std::abs(left_height - right_height) <= 1);
+
+    typename STORAGE::node_type recalculated = current;
+    RANK()(recalculated, nodes.ptr(current.left), nodes.ptr(current.right));
+    CHECK(recalculated.val == current.val);
+    return current.height;
+}
+
+// Checks the whole tree of root in nodes against reference, and returns its height.
+template<class RANK, class TREE, class STORAGE>
+int checkTree(const TREE& tree, const STORAGE& nodes, const typename STORAGE::link& root, const std::set<int>& reference)
+{
+    std::vector<int> keys;
+    int height = checkSubtree<RANK>(nodes, root, typename STORAGE::link(), nullptr, nullptr, keys);
+    CHECK(keys.size() == reference.size() && std::equal(keys.begin(), keys.end(), reference.begin()));
+    CHECK(tree.size() == static_cast<int>(reference.size()));
+    if(reference.empty())
+    {
+        CHECK(!tree.getLowest() && !tree.getHighest());
+    }
+    else
+    {
+        CHECK(tree.getLowest() && tree.getLowest()->key == *reference.begin());
+        CHECK(tree.getHighest() && tree.getHighest()->key == *reference.rbegin());
+    }
+
+    // An AVL tree of n nodes is at most 1.44*log2(n + 2) high:
+    CHECK(height + 1 <= 1.4405 * std::log2(reference.size() + 2.0));
+    return height;
+}
+
+// A RankAVL that can check the links and ranks of all its nodes.
+template<class RANK, class STORAGE>
+class Inspected : public RankAVL<RANK, int, int, STORAGE>
+{
+    typedef RankAVL<RANK, int, int, STORAGE> Tree;
+public:
+    typedef typename Tree::link link;
+    typedef typename Tree::NODE NODE;
+    static const bool SIZED = std::is_same<RANK, SubtreeSize>::value; // The subtree sizes can be read with SizeOf
+
+    Inspected() : Tree(RANK()) { }
+
+    template<class ITERATOR>
+    Inspected(ITERATOR begin, ITERATOR end) : Tree(RANK(), begin, end) { }
+
+    // Checks the whole tree against reference, and returns its height.
+    int check(const std::set<int>& reference) const
+    {
+        return checkTree<RANK>(*this, this->nodes, this->tree_root, reference);
+    }
+};
+
+// An AVL without ranks that can check the links of all its nodes.
+template<class STORAGE>
+class InspectedAVL : public AVL<int, int, STORAGE>
+{
+public:
+    int check(const std::set<int>& reference) const
+    {
+        return checkTree<NoRank>(*this, this->nodes, this->tree_root, reference);
+    }
+};
+
+template<class TREE>
+void randomOperations(unsigned seed, int key_range, int operations)
+{
+    TREE tree;
+    std::set<int> reference;
+    std::map<int, typename TREE::link> handles; // The handle insert returned for every key in the tree
+    std::mt19937 generator(seed);
+    for(int op = 0; op < operations; op++)
+    {
+        int key = generator() % key_range;
+        int dice = generator() % 100;
+        if(dice < 50)
+        {
+            typename TREE::link handle = tree.insert(key, 0); // A key that is already in the tree has its rank recalculated
+            CHECK(!handles.count(key) || handles[key] == handle);
+            handles[key] = handle;
+            reference.insert(key);
+        }
+        else if(dice < 80)
+        {
+            tree.erase(key);
+            reference.erase(key);
+            handles.erase(key);
+        }
+        else if(!reference.empty())
+        {
+            // The lowest or the highest key leaves, by key or by its handle:
+            key = dice % 2? *reference.begin() : *reference.rbegin();
+            if(dice < 90)
+            {
+                tree.erase(key);
+            }
+            else
+            {
+                tree.eraseNode(handles[key]);
+            }
+            reference.erase(key);
+            handles.erase(key);
+        }
+        CHECK(tree.find(key) == (reference.count(key) > 0));
+        tree.check(reference);
+        if(op % 5 == 0)
+        {
+            compareIterators(tree, reference, generator);
+        }
+    }
+}
+
+// Checks that it is the iterator to the key of found in reference (or end() for the end of reference),
+// and that stepping from it gives the keys around found.
+template<class TREE>
+void compareBound(const TREE& tree, typename TREE::const_iterator it, const std::set<int>& reference, std::set<int>::const_iterator found)
+{
+    if(found == reference.end())
+    {
+        CHECK(it == tree.end());
+        CHECK(reference.empty() || (--it)->key == *reference.rbegin());
+        return;
+    }
+    CHECK(it != tree.end() && it->key == *found);
+    auto next = it;
+    ++next;
+    CHECK(std::next(found) == reference.end()? next == tree.end() : next->key == *std::next(found));
+    if(found != reference.begin())
+    {
+        auto prev = it;
+        CHECK((--prev)->key == *std::prev(found));
+    }
+    else
+    {
+        CHECK(it == tree.begin());
+    }
+}
+
+template<class TREE>
+void compareIterators(const TREE& tree, const std::set<int>& reference, std::mt19937& generator)
+{
+    std::vector<int> keys(reference.begin(), reference.end());
+    int n = keys.size();
+    auto same_key = [](int key, const typename TREE::NODE& node) { return key == node.key; };
+
+    std::vector<int> forward, backward, reversed;
+    for(auto it = tree.begin(); it != tree.end(); it++)
+    {
+        forward.push_back((*it).key);
+    }
+    for(auto it = tree.end(); it != tree.begin();)
+    {
+        backward.push_back((--it)->key);
+    }
+    for(auto it = tree.rbegin(); it != tree.rend(); ++it)
+    {
+        reversed.push_back(it->key);
+    }
+    CHECK(forward == keys);
+    CHECK(backward == std::vector<int>(keys.rbegin(), keys.rend()));
+    CHECK(reversed == backward);
+
+    // The bounds of the keys at both ends, past them, and of random keys in and between the keys of the tree:
+    std::vector<int> queries = {-1000000, 1000000};
+    if(n > 0)
+    {
+        for(int offset : {-1, 0, 1})
+        {
+            queries.push_back(keys.front() + offset);
+            queries.push_back(keys.back() + offset);
+        }
+        for(int i = 0; i < 6; i++)
+        {
+            queries.push_back(keys[generator() % n] + static_cast<int>(generator() % 3) - 1);
+        }
+    }
+    for(int key : queries)
+    {
+        compareBound(tree, tree.lower_bound(key), reference, reference.lower_bound(key));
+        compareBound(tree, tree.upper_bound(key), reference, reference.upper_bound(key));
+    }
+
+    // Select then walk: from the root on, or from the i-th lowest key when the tree keeps the subtree sizes.
+    auto root = tree.rankIterator(AtRoot());
+    CHECK(n == 0? root == tree.end() : root != tree.end());
+    if(n > 0)
+    {
+        auto found = reference.find(root->key);
+        CHECK(found != reference.end());
+        CHECK(std::equal(found, reference.end(), root, same_key));
+    }
+    if(TREE::SIZED)
+    {
+        int i = 1 + generator() % (n + 2);
+        auto selected = tree.rankIterator(Select(i));
+        if(i > n)
+        {
+            CHECK(selected == tree.end());
+        }
+        else
+        {
+            CHECK(std::equal(keys.begin() + i - 1, keys.begin() + std::min(n, i + 4), selected, same_key));
+        }
+    }
+}
+
+// Checks that every handle still gives the node of its key.
+template<class TREE>
+void checkHandles(const TREE& tree, const std::map<int, typename TREE::link>& handles)
+{
+    for(const auto& handle : handles)
+    {
+        CHECK(tree.getNodeOf(handle.second).key == handle.first);
+    }
+}
+
+// Erases nodes and changes their keys through the handles insert returned.
+template<class TREE>
+void handleOperations(unsigned seed, int key_range, int operations)
+{
+    TREE tree;
+    std::set<int> reference;
+    std::map<int, typename TREE::link> handles;
+    std::mt19937 generator(seed);
+    for(int op = 0; op < operations; op++)
+    {
+        int key = generator() % key_range;
+        int dice = generator() % 100;
+        if(dice < 35 || reference.empty())
+        {
+            handles[key] = tree.insert(key, 0);
+            reference.insert(key);
+            tree.check(reference);
+            continue;
+        }
+        if(dice < 45)
+        {
+            tree.erase(key);
+            reference.erase(key);
+            handles.erase(key);
+            tree.check(reference);
+            continue;
+        }
+
+        // A random node of the tree, and the keys around it:
+        auto chosen = std::next(reference.begin(), generator() % reference.size());
+        int old_key = *chosen;
+        typename TREE::link handle = handles[old_key];
+        int prev = chosen == reference.begin()? old_key - 10 : *std::prev(chosen);
+        int next = std::next(chosen) == reference.end()? old_key + 10 : *std::next(chosen);
+        if(dice < 60)
+        {
+            tree.eraseNode(handle);
+            reference.erase(old_key);
+            handles.erase(old_key);
+        }
+        else if(dice < 75)
+        {
+            // A key between the neighbours keeps the node in its place:
+            int new_key = prev + 1 + static_cast<int>(generator() % (next - prev - 1));
+            tree.updateKey(handle, new_key);
+            reference.erase(old_key);
+            reference.insert(new_key);
+            handles.erase(old_key);
+            handles[new_key] = handle;
+        }
+        else if(dice < 90)
+        {
+            // A key that is not in the tree, anywhere in the range, moves the node:
+            int new_key;
+            do
+            {
+                new_key = generator() % (2 * key_range);
+            } while(reference.count(new_key));
+            tree.updateKey(handle, new_key);
+            reference.erase(old_key);
+            reference.insert(new_key);
+            handles.erase(old_key);
+            handles[new_key] = handle;
+        }
+        else
+        {
+            // A key that another node holds leaves the tree as it was:
+            int taken = *std::next(reference.begin(), generator() % reference.size());
+            bool thrown = false;
+            try
+            {
+                tree.updateKey(handle, taken);
+            }
+            catch(const KeyAlreadyExists& e)
+            {
+                thrown = true;
+            }
+            CHECK(thrown == (taken != old_key));
+        }
+        tree.check(reference);
+        checkHandles(tree, handles);
+    }
+}
+
+// Inserts count keys in ascending and then descending order, and erases them the same ways.
+// Every insert goes down the longest path of the tree and rotates on the way back.
+template<class TREE>
+void sortedRuns(int count)
+{
+    TREE tree;
+    std::set<int> reference;
+    for(int key = 0; key < count; key++)
+    {
+        tree.insert(key, 0);
+        reference.insert(key);
+    }
+    for(int key = -1; key >= -count; key--)
+    {
+        tree.insert(key, 0);
+        reference.insert(key);
+    }
+    tree.check(reference);
+    for(int key = -count; key < 0; key++)
+    {
+        tree.erase(key);
+        reference.erase(key);
+    }
+    tree.check(reference);
+    for(int key = count - 1; key >= count / 2; key--)
+    {
+        tree.erase(key);
+        reference.erase(key);
+    }
+    tree.check(reference);
+}
+
+// Splits a tree of count keys (multiples of 4) at random keys and joins the halves back, again and again.
+template<class TREE>
+void splitJoin(unsigned seed, int count, int rounds)
+{
+    TREE tree, other;
+    std::set<int> reference;
+    std::mt19937 generator(seed);
+    for(int i = 0; i < count; i++)
+    {
+        int key = 4 * static_cast<int>(generator() % (2 * count));
+        tree.insert(key, 0);
+        reference.insert(key);
+    }
+    tree.check(reference);
+
+    for(int round = 0; round < rounds; round++)
+    {
+        // The other tree holds keys of its own, which the split replaces:
+        std::set<int> replaced;
+        for(int i = generator() % 4; i > 0; i--)
+        {
+            int key = -1 - static_cast<int>(generator() % 100);
+            other.insert(key, 0);
+            replaced.insert(key);
+        }
+        other.check(replaced);
+
+        int dice = generator() % 10;
+        int key = dice == 0? -1 : dice == 1? 8 * count + 1 : static_cast<int>(generator() % (8 * count + 2));
+        bool found;
+        if(TREE::SIZED && generator() % 2)
+        {
+            found = tree.split(key, other, SizeOf());
+        }
+        else
+        {
+            found = tree.split(key, other);
+        }
+        CHECK(found == (reference.count(key) > 0));
+        std::set<int> low(reference.begin(), reference.lower_bound(key));
+        std::set<int> high(reference.lower_bound(key), reference.end());
+        tree.check(low);
+        other.check(high);
+        compareIterators(tree, low, generator);
+        compareIterators(other, high, generator);
+
+        // Join the halves back around a key between them, which is then erased again:
+        int middle = low.empty()? (high.empty()? 0 : *high.begin() - 1) : *low.rbegin() + 1;
+        tree.join(middle, 0, other);
+        reference.insert(middle);
+        tree.check(reference);
+        other.check(std::set<int>());
+        tree.erase(middle);
+        reference.erase(middle);
+        tree.check(reference);
+    }
+}
+
+// The numbers of keys to build trees of: the smallest, the ones around every full tree up to 4096 keys, and random ones.
+std::vector<int> buildSizes(std::mt19937& generator)
+{
+    std::vector<int> sizes = {0, 1, 2, 3};
+    for(int k = 2; k <= 12; k++)
+    {
+        sizes.push_back((1 << k) - 1);
+        sizes.push_back(1 << k);
+    }
+    for(int i = 0; i < 8; i++)
+    {
+        sizes.push_back(generator() % 5000);
+    }
+    return sizes;
+}
+
+// Returns count distinct random keys.
+std::set<int> randomKeys(int count, std::mt19937& generator)
+{
+    std::set<int> keys;
+    for(int key = 0; static_cast<int>(keys.size()) < count; key += 1 + generator() % 3)
+    {
+        keys.insert(key);
+    }
+    return keys;
+}
+
+// Checks a tree that was just built out of the keys of reference, and that it takes inserts and erases.
+template<class TREE>
+void checkBuilt(TREE& tree, std::set<int> reference, std::mt19937& generator)
+{
+    int perfect = -1; // A perfectly balanced tree of n nodes is floor(log2(n)) high
+    for(int n = reference.size(); n > 0; n /= 2)
+    {
+        perfect++;
+    }
+    CHECK(tree.check(reference) == perfect);
+
+    int key_range = 3 * reference.size() + 10;
+    for(int i = 0; i < 20; i++)
+    {
+        int key = generator() % key_range;
+        if(i % 2)
+        {
+            tree.insert(key, 0);
+            reference.insert(key);
+        }
+        else
+        {
+            tree.erase(key);
+            reference.erase(key);
+        }
+    }
+    tree.check(reference);
+}
+
+// Replaces the contents of trees with assignSorted and assignUnsorted.
+template<class TREE>
+void assignKeys(unsigned seed)
+{
+    std::mt19937 generator(seed);
+    TREE tree;
+    for(int count : buildSizes(generator))
+    {
+        std::set<int> reference = randomKeys(count, generator);
+        tree.insert(-5, 0); // The keys the tree held before are dropped
+        tree.assignSorted(reference.begin(), reference.end());
+        checkBuilt(tree, reference, generator);
+
+        std::vector<int> unsorted(reference.begin(), reference.end());
+        for(int i = 0; i < count; i += 1 + generator() % 4)
+        {
+            unsorted.push_back(unsorted[i]);
+        }
+        std::shuffle(unsorted.begin(), unsorted.end(), generator);
+        tree.insert(-5, 0);
+        tree.assignUnsorted(unsorted.begin(), unsorted.end());
+        checkBuilt(tree, reference, generator);
+    }
+}
+
+// Builds RankAVL trees with the range constructor.
+template<class TREE>
+void constructFromRange(unsigned seed)
+{
+    std::mt19937 generator(seed);
+    for(int count : buildSizes(generator))
+    {
+        std::set<int> reference = randomKeys(count, generator);
+        TREE tree(reference.begin(), reference.end());
+        checkBuilt(tree, reference, generator);
+    }
+}
+
+typedef NodePool<int, int> Pool;
+
+// Links the nodes of keys into pool as a perfectly balanced tree under father, and returns its root.
+Pool::link buildPool(Pool& pool, const int* keys, int count, Pool::link father)
+{
+    if(count <= 0)
+    {
+        return 0;
+    }
+    Pool::link root = pool.allocate();
+    pool[root].key = keys[count / 2];
+    pool[root].father = father;
+    Pool::link left = buildPool(pool, keys, count / 2, root);
+    Pool::link right = buildPool(pool, keys + count / 2 + 1, count - count / 2 - 1, root);
+    pool[root].left = left;
+    pool[root].right = right;
+    return root;
+}
+
+// Appends the keys of the tree of root in pool in order, checking its father links.
+void poolKeys(const Pool& pool, Pool::link root, Pool::link father, std::vector<int>& keys)
+{
+    if(root)
+    {
+        CHECK(pool[root].father == father);
+        poolKeys(pool, pool[root].left, root, keys);
+        keys.push_back(pool[root].key);
+        poolKeys(pool, pool[root].right, root, keys);
+    }
+}
+
+void nodePool()
+{
+    Pool pool;
+    CHECK(!pool.ptr(0));
+    std::vector<Pool::link> links;
+    for(int i = 1; i <= 40; i++)
+    {
+        Pool::link l = pool.allocate(); // The cell 0 is never handed out
+        CHECK(l == static_cast<Pool::link>(i) && pool.ptr(l) == &pool[l]);
+        pool[l].key = i;
+        links.push_back(l);
+    }
+
+    // Released cells come back last first, reset to a default node:
+    for(int i : {3, 17, 29})
+    {
+        pool.release(links[i]);
+    }
+    for(int i : {29, 17, 3})
+    {
+        Pool::link l = pool.allocate();
+        CHECK(l == links[i]);
+        CHECK(pool[l].key == 0 && pool[l].val == 0 && pool[l].height == 0);
+        CHECK(!pool[l].father && !pool[l].left && !pool[l].right);
+        pool[l].key = i + 1;
+    }
+    CHECK(pool.allocate() == 41);
+
+    // After a reserve, as many allocations do not move the slab:
+    pool.reserve(1000);
+    const Pool::node_type* first = pool.ptr(1);
+    for(int i = 0; i < 1000; i++)
+    {
+        pool.allocate();
+    }
+    CHECK(pool.ptr(1) == first && pool[1].key == 1);
+
+    // A tree adopted into another pool keeps its keys and links, and its cells in the first pool are released:
+    std::vector<int> keys;
+    for(int key = 0; key < 100; key++)
+    {
+        keys.push_back(3 * key);
+    }
+    Pool from;
+    Pool::link root = buildPool(from, keys.data(), keys.size(), 0);
+    from[root].father = 1; // adopt detaches the root
+    Pool into(pool);
+    CHECK(into[40].key == 40 && into.ptr(40) != pool.ptr(40)); // The copy has nodes of its own
+    Pool::link adopted = into.adopt(from, root);
+    CHECK(adopted > 1041);
+    std::vector<int> in_order;
+    poolKeys(into, adopted, 0, in_order);
+    CHECK(in_order == keys);
+    std::set<Pool::link> reused;
+    for(int i = 0; i < 100; i++)
+    {
+        reused.insert(from.allocate());
+    }
+    CHECK(reused.size() == 100 && *reused.begin() == 1 && *reused.rbegin() == 100);
+
+    // swap exchanges the nodes, and clear empties the pool and the root:
+    into.swap(pool);
+    in_order.clear();
+    poolKeys(pool, adopted, 0, in_order);
+    CHECK(in_order == keys && into[40].key == 40);
+    pool.clear(adopted);
+    CHECK(!adopted && pool.allocate() == 1);
+}
+
+// A pooled tree allocates the cells of the keys it erased for the next keys, and a reserve keeps its nodes in place.
+template<class TREE>
+void poolReuse()
+{
+    TREE tree;
+    std::set<int> reference;
+    std::map<int, typename TREE::link> handles;
+    for(int key = 0; key < 100; key++)
+    {
+        handles[key] = tree.insert(key, 0);
+        reference.insert(key);
+    }
+    std::set<typename TREE::link> released;
+    for(int key = 0; key < 100; key += 3)
+    {
+        released.insert(handles[key]);
+        tree.erase(key);
+        reference.erase(key);
+        handles.erase(key);
+    }
+    std::set<typename TREE::link> allocated;
+    for(int key = 100; key < 100 + static_cast<int>(released.size()); key++)
+    {
+        handles[key] = tree.insert(key, 0);
+        allocated.insert(handles[key]);
+        reference.insert(key);
+    }
+    CHECK(allocated == released && !allocated.count(0));
+    tree.check(reference);
+    checkHandles(tree, handles);
+
+    tree.reserve(5000);
+    const typename TREE::NODE* lowest = tree.getLowest();
+    for(int key = 1000; key < 6000; key++)
+    {
+        tree.insert(key, 0);
+        reference.insert(key);
+    }
+    CHECK(tree.getLowest() == lowest);
+    tree.check(reference);
+}
+
+template<class RANK>
+void checkStorages()
+{
+    typedef Inspected<RANK, SharedNodes<int, int>> Shared;
+    typedef Inspected<RANK, NodePool<int, int>> Pooled;
+    for(unsigned seed = 1; seed <= 2; seed++)
+    {
+        randomOperations<Shared>(seed, 200, 10000);
+        randomOperations<Pooled>(seed, 200, 10000);
+        randomOperations<Pooled>(seed, 3000, 5000);
+    }
+    sortedRuns<Shared>(1 << 15);
+    sortedRuns<Pooled>(1 << 15);
+    poolReuse<Pooled>();
+    assignKeys<Shared>(1);
+    assignKeys<Pooled>(2);
+    constructFromRange<Shared>(3);
+    constructFromRange<Pooled>(4);
+    for(unsigned seed = 1; seed <= 2; seed++)
+    {
+        handleOperations<Shared>(seed, 300, 8000);
+        handleOperations<Pooled>(seed, 300, 8000);
+    }
+    for(int count : {1, 2, 50, 1000})
+    {
+        splitJoin<Shared>(count, count, 300);
+        splitJoin<Pooled>(count, count, 300);
+    }
+}
+
+int main()
+{
+    nodePool();
+    checkStorages<SubtreeSize>();
+    checkStorages<HeaviestKey>();
+    assignKeys<InspectedAVL<SharedNodes<int, int>>>(5);
+    assignKeys<InspectedAVL<NodePool<int, int>>>(6);
+    cout << "RankAVL OK" << endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+#include "Check.h"
+#include "../RankBTree/RankBTree.h"
+
+using std::cout;
+using std::endl;
+using namespace DS;
+
+// Checks RankBTree against std::set on random inserts and erases, with small nodes (so there are many splits
+// and merges) and with the default ones. Every few operations the whole tree is compared: both iteration
+// orders, every select, and moves of the iterators by random distances.
+// Usage: rank_btree_test
+
+template<int FANOUT, int LEAF_SIZE>
+void compareTree(const RankBTree<int, FANOUT, LEAF_SIZE>& tree, const std::set<int>& reference, std::mt19937& generator)
+{
+    typedef typename RankBTree<int, FANOUT, LEAF_SIZE>::const_iterator iterator;
+    std::vector<int> keys(reference.begin(), reference.end());
+    int n = keys.size();
+    CHECK(tree.size() == n);
+
+    int i = 0;
+    for(iterator current = tree.begin(); current != tree.end(); ++current, i++)
+    {
+        CHECK(i < n && *current == keys[i]);
+    }
+    CHECK(i == n);
+    for(iterator current = tree.end(); current != tree.begin();)
+    {
+        --current;
+        CHECK(*current == keys[--i]);
+    }
+
+    for(int position = 1; position <= n; position++)
+    {
+        CHECK(*tree.select(position) == keys[position - 1]);
+    }
+    CHECK(tree.select(0) == tree.end());
+    CHECK(tree.select(n + 1) == tree.end());
+
+    for(int k = 0; n && k < 50; k++)
+    {
+        int from = 1 + generator() % n;
+        int distance = static_cast<int>(generator() % (2 * n + 1)) - n;
+        int to = from + distance;
+        iterator forward = tree.select(from);
+        iterator back = tree.select(from);
+        forward += distance;
+        back -= -distance;
+        CHECK(forward == back);
+        CHECK(to >= 1 && to <= n? *forward == keys[to - 1] : forward == tree.end());
+    }
+}
+
+template<int FANOUT, int LEAF_SIZE>
+void randomOperations(unsigned seed, int key_range, int operations, int compare_every)
+{
+    RankBTree<int, FANOUT, LEAF_SIZE> tree;
+    std::set<int> reference;
+    std::mt19937 generator(seed);
+    for(int op = 0; op < operations; op++)
+    {
+        int key = generator() % key_range;
+        int dice = generator() % 5;
+        if(dice < 2)
+        {
+            CHECK(tree.insert(key) == reference.insert(key).second);
+        }
+        else if(dice < 4)
+        {
+            CHECK(tree.erase(key) == (reference.erase(key) > 0));
+        }
+        else
+        {
+            CHECK(tree.find(key) == (reference.count(key) > 0));
+            CHECK(tree.countLower(key) == std::distance(reference.begin(), reference.lower_bound(key)));
+        }
+        CHECK(tree.size() == static_cast<int>(reference.size()));
+        if(op % compare_every == 0)
+        {
+            compareTree(tree, reference, generator);
+        }
+    }
+    compareTree(tree, reference, generator);
+}
+
+int main()
+{
+    for(unsigned seed = 1; seed <= 3; seed++)
+    {
+        randomOperations<4, 4>(seed, 300, 40000, 97);
+        randomOperations<8, 5>(seed, 2000, 40000, 397);
+        randomOperations<32, 32>(seed, 20000, 100000, 4999);
+    }
+    cout << "RankBTree OK" << endl;
+    return 0;
+}
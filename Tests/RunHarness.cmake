@@ -0,0 +1,18 @@
+# Runs the command harness on an input file and compares what it prints with the expected output.
+# Usage: cmake -DHARNESS=<main2> -DINPUT=<in2.txt> -DEXPECTED=<out2.txt> [-DHINTS="<courses>;<classes per course>"]
+#              -P RunHarness.cmake
+# With HINTS the harness builds its instance with InitWithCapacity instead of Init.
+
+execute_process(COMMAND ${HARNESS} ${HINTS}
+                INPUT_FILE ${INPUT}
+                OUTPUT_VARIABLE output
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${HARNESS} exited with ${result}")
+endif()
+
+file(READ ${EXPECTED} expected)
+if(NOT output STREQUAL expected)
+    file(WRITE ${CMAKE_CURRENT_BINARY_DIR}/harness_output.txt "${output}")
+    message(FATAL_ERROR "The output differs from ${EXPECTED}, see ${CMAKE_CURRENT_BINARY_DIR}/harness_output.txt")
+endif()
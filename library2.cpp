@@ -17,6 +17,27 @@ void* Init()
     return (void*)DS;
 }
 
+void* InitWithCapacity(int expectedCourses, int expectedClassesPerCourse)
+{
+    Boom2* DS = NULL;
+    try
+    {
+        DS = new Boom2();
+        DS->reserve(expectedCourses, expectedClassesPerCourse);
+    }
+    catch(const Boom2::InvalidInput& e)
+    {
+        delete DS;
+        DS = NULL;
+    }
+    catch(const std::bad_alloc& e)
+    {
+        delete DS;
+        DS = NULL;
+    }
+    return (void*)DS;
+}
+
 StatusType AddCourse(void* DS, int courseID)
 {
     if(!DS)
@@ -173,6 +194,84 @@ StatusType GetIthWatchedClass(void* DS, int i, int* courseID, int* classID)
     return SUCCESS;
 }
 
+StatusType GetIthWatchedClasses(void* DS, const int* is, int count, int* courseIDs, int* classIDs)
+{
+    if(!DS)
+    {
+        return INVALID_INPUT;
+    }
+    bool res;
+    try
+    {
+        res = static_cast<Boom2*>(DS)->getIthWatchedClasses(is, count, courseIDs, classIDs);
+    }
+    catch(const Boom2::InvalidInput& e)
+    {
+        return INVALID_INPUT;
+    }
+    catch(const std::bad_alloc& e)
+    {
+        return ALLOCATION_ERROR;
+    }
+    if(!res)
+    {
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+StatusType GetWatchedClassesRange(void* DS, int from, int to, int* courseIDs, int* classIDs)
+{
+    if(!DS)
+    {
+        return INVALID_INPUT;
+    }
+    bool res;
+    try
+    {
+        res = static_cast<Boom2*>(DS)->getWatchedClassesRange(from, to, courseIDs, classIDs);
+    }
+    catch(const Boom2::InvalidInput& e)
+    {
+        return INVALID_INPUT;
+    }
+    catch(const std::bad_alloc& e)
+    {
+        return ALLOCATION_ERROR;
+    }
+    if(!res)
+    {
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+StatusType GetRankOfClass(void* DS, int courseID, int classID, int* rank)
+{
+    if(!DS)
+    {
+        return INVALID_INPUT;
+    }
+    bool res;
+    try
+    {
+        res = static_cast<Boom2*>(DS)->getRankOfClass(courseID, classID, rank);
+    }
+    catch(const Boom2::InvalidInput& e)
+    {
+        return INVALID_INPUT;
+    }
+    catch(const std::bad_alloc& e)
+    {
+        return ALLOCATION_ERROR;
+    }
+    if(!res)
+    {
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
 void Quit(void **DS)
 {
     if(!DS)
@@ -30,6 +30,11 @@ typedef enum {
 
 void *Init();
 
+/* Like Init, but makes room for expectedCourses courses with expectedClassesPerCourse classes each,
+ * so that loading them does not resize any of the structures. Returns NULL if the room could not be allocated,
+ * or if one of the numbers is negative. */
+void *InitWithCapacity(int expectedCourses, int expectedClassesPerCourse);
+
 StatusType AddCourse(void* DS, int courseID);
 
 StatusType RemoveCourse(void *DS, int courseID);
@@ -42,6 +47,12 @@ StatusType TimeViewed(void *DS, int courseID, int classID, int *timeViewed);
 
 StatusType GetIthWatchedClass(void* DS, int i, int* courseID, int* classID);
 
+StatusType GetIthWatchedClasses(void* DS, const int* is, int count, int* courseIDs, int* classIDs);
+
+StatusType GetWatchedClassesRange(void* DS, int from, int to, int* courseIDs, int* classIDs);
+
+StatusType GetRankOfClass(void* DS, int courseID, int classID, int* rank);
+
 void Quit(void** DS);
 
 #ifdef __cplusplus
@@ -34,10 +34,14 @@ typedef enum {
     WATCHCLASS_CMD = 4,
     TIMEVIEWED_CMD = 5,
     GETITH_CMD = 6,
-    QUIT_CMD = 7
+    QUIT_CMD = 7,
+    GETRANGE_CMD = 8,
+    GETRANK_CMD = 9,
+    GETITHS_CMD = 10,
+    INITCAPACITY_CMD = 11
 } commandType;
 
-static const int numActions = 10;
+static const int numActions = 12;
 static const char *commandStr[] = {
         "Init",
         "AddCourse",
@@ -46,7 +50,11 @@ static const char *commandStr[] = {
         "WatchClass",
         "TimeViewed",
         "GetIthWatchedClass",
-        "Quit" };
+        "Quit",
+        "GetWatchedClassesRange",
+        "GetRankOfClass",
+        "GetIthWatchedClasses",
+        "InitWithCapacity" };
 
 static const char* ReturnValToStr(int val) {
     switch (val) {
@@ -79,13 +87,24 @@ if ( (read_parameters)!=(required_parameters) ) { printf(ErrorString, ErrorParam
 
 static bool isInit = false;
 
+/* When main gets capacity hints, Init makes room for them (see InitWithCapacity) */
+static bool useCapacity = false;
+static int expectedCourses = 0;
+static int expectedClassesPerCourse = 0;
+
 /***************************************************************************/
 /* main                                                                    */
 /***************************************************************************/
 
+/* Usage: main2 [expectedCourses expectedClassesPerCourse] < input */
 int main(int argc, const char**argv) {
 
     char buffer[MAX_STRING_INPUT_SIZE];
+    if (argc == 3) {
+        useCapacity = true;
+        expectedCourses = atoi(argv[1]);
+        expectedClassesPerCourse = atoi(argv[2]);
+    }
     // FILE *fd = fopen("in_3.txt", "r");
     // if(!fd)
     // {
@@ -114,7 +133,9 @@ static commandType CheckCommand(const char* const command,
         return (COMMENT_CMD);
     };
     for (int index = 0; index < numActions; index++) {
-        if (StrCmp(commandStr[index], command)) {
+        /* The whole word must match, since some commands start with the name of another */
+        char next = command[strlen(commandStr[index])];
+        if (StrCmp(commandStr[index], command) && (next == ' ' || next == '\n' || next == '\r' || next == '\0')) {
             *command_arg = command + strlen(commandStr[index]) + 1;
             return ((commandType)index);
         };
@@ -134,6 +155,10 @@ static errorType OnWatchClass(void* DS, const char* const command);
 static errorType OnTimeViewed(void* DS, const char* const command);
 static errorType OnGetIthWatchedClass(void* DS, const char* const command);
 static errorType OnQuit(void** DS, const char* const command);
+static errorType OnGetWatchedClassesRange(void* DS, const char* const command);
+static errorType OnGetRankOfClass(void* DS, const char* const command);
+static errorType OnGetIthWatchedClasses(void* DS, const char* const command);
+static errorType OnInitWithCapacity(void** DS, const char* const command);
 
 /***************************************************************************/
 /* Parser                                                                  */
@@ -172,6 +197,18 @@ static errorType parser(const char* const command) {
         case (QUIT_CMD):
             rtn_val = OnQuit(&DS, command_args);
             break;
+        case (GETRANGE_CMD):
+            rtn_val = OnGetWatchedClassesRange(DS, command_args);
+            break;
+        case (GETRANK_CMD):
+            rtn_val = OnGetRankOfClass(DS, command_args);
+            break;
+        case (GETITHS_CMD):
+            rtn_val = OnGetIthWatchedClasses(DS, command_args);
+            break;
+        case (INITCAPACITY_CMD):
+            rtn_val = OnInitWithCapacity(&DS, command_args);
+            break;
 
         case (COMMENT_CMD):
             rtn_val = error_free;
@@ -194,7 +231,7 @@ static errorType OnInit(void** DS, const char* const command) {
     isInit = true;
 
     ValidateRead(0, 0, "%s failed.\n", commandStr[INIT_CMD]);
-    *DS = Init();
+    *DS = useCapacity ? InitWithCapacity(expectedCourses, expectedClassesPerCourse) : Init();
 
     if (*DS == NULL) {
         printf("init failed.\n");
@@ -301,6 +338,116 @@ static errorType OnQuit(void** DS, const char* const command) {
     return error_free;
 }
 
+/* Prints the classes as "courseID classID" pairs, separated by commas */
+static void PrintClasses(const char* name, const int* courseIDs, const int* classIDs, int count) {
+    printf("%s:", name);
+    for (int k = 0; k < count; k++) {
+        printf("%s %d %d", k ? "," : "", courseIDs[k], classIDs[k]);
+    }
+    printf("\n");
+}
+
+static errorType OnGetWatchedClassesRange(void* DS, const char* const command) {
+    int from, to;
+    ValidateRead(sscanf(command, "%d %d", &from, &to), 2, "%s failed.\n", commandStr[GETRANGE_CMD]);
+    int count = (to >= from) ? to - from + 1 : 1;
+    int* courseIDs = (int*)malloc(count * sizeof(int));
+    int* classIDs = (int*)malloc(count * sizeof(int));
+    if (courseIDs == NULL || classIDs == NULL) {
+        free(courseIDs);
+        free(classIDs);
+        printf("%s: %s\n", commandStr[GETRANGE_CMD], ReturnValToStr(ALLOCATION_ERROR));
+        return error_free;
+    }
+    StatusType res = GetWatchedClassesRange(DS, from, to, courseIDs, classIDs);
+
+    if (res != SUCCESS) {
+        printf("%s: %s\n", commandStr[GETRANGE_CMD], ReturnValToStr(res));
+    }
+    else {
+        PrintClasses(commandStr[GETRANGE_CMD], courseIDs, classIDs, count);
+    }
+    free(courseIDs);
+    free(classIDs);
+    return error_free;
+}
+
+static errorType OnGetRankOfClass(void* DS, const char* const command) {
+    int courseID, classID, rank;
+    ValidateRead(sscanf(command, "%d %d", &courseID, &classID), 2, "%s failed.\n", commandStr[GETRANK_CMD]);
+    StatusType res = GetRankOfClass(DS, courseID, classID, &rank);
+
+    if (res != SUCCESS) {
+        printf("%s: %s\n", commandStr[GETRANK_CMD], ReturnValToStr(res));
+        return error_free;
+    }
+
+    printf("%s: %d\n", commandStr[GETRANK_CMD], rank);
+    return error_free;
+}
+
+/* Reads "count i_1 ... i_count" and asks for all of the ranks at once */
+static errorType OnGetIthWatchedClasses(void* DS, const char* const command) {
+    int count, offset;
+    ValidateRead(sscanf(command, "%d%n", &count, &offset), 1, "%s failed.\n", commandStr[GETITHS_CMD]);
+    int size = (count > 0) ? count : 1;
+    int* is = (int*)malloc(size * sizeof(int));
+    int* courseIDs = (int*)malloc(size * sizeof(int));
+    int* classIDs = (int*)malloc(size * sizeof(int));
+    if (is == NULL || courseIDs == NULL || classIDs == NULL) {
+        free(is);
+        free(courseIDs);
+        free(classIDs);
+        printf("%s: %s\n", commandStr[GETITHS_CMD], ReturnValToStr(ALLOCATION_ERROR));
+        return error_free;
+    }
+    const char* next = command + offset;
+    for (int k = 0; k < count; k++) {
+        int read;
+        if (sscanf(next, "%d%n", &is[k], &read) != 1) {
+            free(is);
+            free(courseIDs);
+            free(classIDs);
+            printf("%s failed.\n", commandStr[GETITHS_CMD]);
+            return error;
+        }
+        next += read;
+    }
+    StatusType res = GetIthWatchedClasses(DS, is, count, courseIDs, classIDs);
+
+    if (res != SUCCESS) {
+        printf("%s: %s\n", commandStr[GETITHS_CMD], ReturnValToStr(res));
+    }
+    else {
+        PrintClasses(commandStr[GETITHS_CMD], courseIDs, classIDs, count);
+    }
+    free(is);
+    free(courseIDs);
+    free(classIDs);
+    return error_free;
+}
+
+/* Unlike Init, a failure is only reported, so the hints that can not be met are testable */
+static errorType OnInitWithCapacity(void** DS, const char* const command) {
+    if (isInit) {
+        printf("init was already called.\n");
+        return (error_free);
+    };
+
+    int courses, classesPerCourse;
+    ValidateRead(sscanf(command, "%d %d", &courses, &classesPerCourse), 2, "%s failed.\n", commandStr[INITCAPACITY_CMD]);
+    *DS = InitWithCapacity(courses, classesPerCourse);
+
+    if (*DS == NULL) {
+        printf("%s failed.\n", commandStr[INITCAPACITY_CMD]);
+        return error_free;
+    };
+
+    isInit = true;
+    printf("init done.\n");
+    return error_free;
+}
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file